@@ -0,0 +1,66 @@
+#include "Box.h"
+
+namespace df {
+
+Box::Box() : m_corner(0, 0), m_horizontal(1), m_vertical(1) {}
+
+Box::Box(Vector init_corner, float init_horizontal, float init_vertical)
+    : m_corner(init_corner)
+    , m_horizontal(init_horizontal)
+    , m_vertical(init_vertical)
+{}
+
+void Box::setCorner(Vector new_corner) {
+    m_corner = new_corner;
+}
+
+Vector Box::getCorner() const {
+    return m_corner;
+}
+
+void Box::setHorizontal(float new_horizontal) {
+    m_horizontal = new_horizontal;
+}
+
+float Box::getHorizontal() const {
+    return m_horizontal;
+}
+
+void Box::setVertical(float new_vertical) {
+    m_vertical = new_vertical;
+}
+
+float Box::getVertical() const {
+    return m_vertical;
+}
+
+bool Box::intersects(const Box &other) const {
+    return m_corner.getX() < other.m_corner.getX() + other.m_horizontal &&
+           other.m_corner.getX() < m_corner.getX() + m_horizontal &&
+           m_corner.getY() < other.m_corner.getY() + other.m_vertical &&
+           other.m_corner.getY() < m_corner.getY() + m_vertical;
+}
+
+Box Box::translated(Vector offset) const {
+    return Box(m_corner + offset, m_horizontal, m_vertical);
+}
+
+Box Box::merged(const Box &other) const {
+    float left = (m_corner.getX() < other.m_corner.getX()) ? m_corner.getX() : other.m_corner.getX();
+    float top = (m_corner.getY() < other.m_corner.getY()) ? m_corner.getY() : other.m_corner.getY();
+    float right = m_corner.getX() + m_horizontal;
+    float other_right = other.m_corner.getX() + other.m_horizontal;
+    if (other_right > right) right = other_right;
+    float bottom = m_corner.getY() + m_vertical;
+    float other_bottom = other.m_corner.getY() + other.m_vertical;
+    if (other_bottom > bottom) bottom = other_bottom;
+    return Box(Vector(left, top), right - left, bottom - top);
+}
+
+bool Box::operator==(const Box &other) const {
+    return m_corner == other.m_corner &&
+           m_horizontal == other.m_horizontal &&
+           m_vertical == other.m_vertical;
+}
+
+} // end namespace df
@@ -0,0 +1,51 @@
+#pragma once
+
+#include "Vector.h"
+
+namespace df {
+
+// Axis-aligned rectangle: top left corner plus size, in spaces
+class Box {
+private:
+    Vector m_corner;      // Top left corner
+    float m_horizontal;   // Width
+    float m_vertical;     // Height
+
+public:
+    // Default constructor: unit box at (0,0)
+    Box();
+
+    // Constructor with corner and size
+    Box(Vector init_corner, float init_horizontal, float init_vertical);
+
+    // Set top left corner
+    void setCorner(Vector new_corner);
+
+    // Get top left corner
+    Vector getCorner() const;
+
+    // Set width
+    void setHorizontal(float new_horizontal);
+
+    // Get width
+    float getHorizontal() const;
+
+    // Set height
+    void setVertical(float new_vertical);
+
+    // Get height
+    float getVertical() const;
+
+    // Return true if boxes overlap (touching edges do not)
+    bool intersects(const Box &other) const;
+
+    // Return box moved by offset
+    Box translated(Vector offset) const;
+
+    // Return smallest box containing this box and other
+    Box merged(const Box &other) const;
+
+    bool operator==(const Box &other) const;
+};
+
+} // end namespace df
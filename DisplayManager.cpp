@@ -1,17 +1,67 @@
 #include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 
 #include "DisplayManager.h"
 #include "LogManager.h"
+#include "Clock.h"
 #include "Color.h"
 #include "Manager.h"
 #include "Vector.h"
+#include "WorldManager.h"
 
 namespace df {
 
-DisplayManager::DisplayManager() {
+// Convert Dragonfly color to SFML color
+static sf::Color toSFMLColor(Color color) {
+    switch (color) {
+    case YELLOW:  return sf::Color::Yellow;
+    case RED:     return sf::Color::Red;
+    case BLACK:   return sf::Color::Black;
+    case GREEN:   return sf::Color::Green;
+    case BLUE:    return sf::Color::Blue;
+    case MAGENTA: return sf::Color::Magenta;
+    case CYAN:    return sf::Color::Cyan;
+    case WHITE:
+    default:      return sf::Color::White;
+    }
+}
+
+// Vertices per cell: two triangles of background, two of glyph
+static const int VERTICES_PER_CELL = 12;
+
+// Write rectangle (left, top, right, bottom) as two triangles at
+// vertices[at], mapping texture rectangle (tex_left, tex_top, tex_right,
+// tex_bottom) onto it.
+static void setQuad(sf::VertexArray &vertices, int at, sf::Color color,
+                    float left, float top, float right, float bottom,
+                    float tex_left, float tex_top,
+                    float tex_right, float tex_bottom) {
+    sf::Vertex top_left     {{left,  top},    color, {tex_left,  tex_top}};
+    sf::Vertex top_right    {{right, top},    color, {tex_right, tex_top}};
+    sf::Vertex bottom_left  {{left,  bottom}, color, {tex_left,  tex_bottom}};
+    sf::Vertex bottom_right {{right, bottom}, color, {tex_right, tex_bottom}};
+    vertices[at + 0] = top_left;
+    vertices[at + 1] = top_right;
+    vertices[at + 2] = bottom_left;
+    vertices[at + 3] = bottom_left;
+    vertices[at + 4] = top_right;
+    vertices[at + 5] = bottom_right;
+}
+
+DisplayManager::DisplayManager()
+    : m_vertices(sf::PrimitiveType::Triangles)
+{
     setType("DisplayManager");
     m_p_window = nullptr;
+    m_p_texture = nullptr;
+    m_headless = false;
+    m_offscreen = false;
+    m_vsync = true;
+    m_swap_wait = 0;
+    m_char_size = 0;
+    m_dirty_count = 0;
     m_window_horizontal_chars  = WINDOW_HORIZONTAL_CHARS_DEFAULT;
     m_window_vertical_chars    = WINDOW_VERTICAL_CHARS_DEFAULT;
     m_window_horizontal_pixels = WINDOW_HORIZONTAL_PIXELS_DEFAULT;
@@ -24,29 +74,59 @@ DisplayManager &DisplayManager::getInstance() {
 }
 
 int DisplayManager::startUp() {
-    if (m_p_window != nullptr) {
+    if (isStarted()) {
         return 0; // already started
     }
 
-    // SFML 3: VideoMode takes width/height as separate args (not initializer list)
-    m_p_window = new sf::RenderWindow(
-        sf::VideoMode({(unsigned int)WINDOW_HORIZONTAL_PIXELS_DEFAULT,
-                       (unsigned int)WINDOW_VERTICAL_PIXELS_DEFAULT}),
-        WINDOW_TITLE_DEFAULT);
+    if (m_headless) {
+        resetCells();
+        DF_LOG_INFO("DisplayManager::startUp() - OK (headless)");
+        return Manager::startUp();
+    }
+
+    if (m_offscreen) {
+        m_p_texture = new sf::RenderTexture();
+        if (!m_p_texture->resize({(unsigned int)WINDOW_HORIZONTAL_PIXELS_DEFAULT,
+                                  (unsigned int)WINDOW_VERTICAL_PIXELS_DEFAULT})) {
+            DF_LOG_ERROR("DisplayManager::startUp() - could not create offscreen texture");
+            delete m_p_texture;
+            m_p_texture = nullptr;
+            return -1;
+        }
+    } else {
+        // SFML 3: VideoMode takes width/height as separate args (not initializer list)
+        m_p_window = new sf::RenderWindow(
+            sf::VideoMode({(unsigned int)WINDOW_HORIZONTAL_PIXELS_DEFAULT,
+                           (unsigned int)WINDOW_VERTICAL_PIXELS_DEFAULT}),
+            WINDOW_TITLE_DEFAULT);
 
-    m_p_window->setMouseCursorVisible(false);
-    m_p_window->setVerticalSyncEnabled(true);
+        m_p_window->setMouseCursorVisible(false);
+        m_p_window->setVerticalSyncEnabled(m_vsync);
+    }
 
     // Use relative font path so it works on any machine
     if (!m_font.openFromFile(FONT_FILE_DEFAULT)) {
-        LM.writeLog("DisplayManager::startUp() - ERROR: could not load font '%s'",
-                    FONT_FILE_DEFAULT.c_str());
+        DF_LOG_ERROR("DisplayManager::startUp() - could not load font '%s'",
+                     FONT_FILE_DEFAULT.c_str());
         delete m_p_window;
         m_p_window = nullptr;
+        delete m_p_texture;
+        m_p_texture = nullptr;
         return -1;
     }
 
-    LM.writeLog("DisplayManager::startUp() - OK");
+    // Pre-rasterise every 8-bit character into the font's texture atlas
+    // so the atlas doesn't change while frames are being batched.
+    if (charWidth() < charHeight())
+        m_char_size = (unsigned int)(charWidth() * 2);
+    else
+        m_char_size = (unsigned int)(charHeight() * 2);
+    for (int c = 0; c < 256; c++) {
+        m_glyphs[c] = m_font.getGlyph((char32_t)c, m_char_size, true);
+    }
+    resetCells();
+
+    DF_LOG_INFO("DisplayManager::startUp() - OK");
     return Manager::startUp();
 }
 
@@ -56,17 +136,143 @@ void DisplayManager::shutDown() {
         delete m_p_window;
         m_p_window = nullptr;
     }
+    delete m_p_texture;
+    m_p_texture = nullptr;
     Manager::shutDown();
-    LM.writeLog("DisplayManager::shutDown() - OK");
+    DF_LOG_INFO("DisplayManager::shutDown() - OK");
 }
 
+// Only cells that changed since last frame have their quads rebuilt, so
+// a static screen costs one compare per cell plus a single draw call.
 int DisplayManager::swapBuffers() {
-    if (m_p_window == nullptr) return -1;
+    if (!isStarted()) return -1;
+
+    m_dirty_count = 0;
+    for (int i = 0; i < (int)m_cells.size(); i++) {
+        if (m_cells[i] != m_shown[i]) {
+            m_shown[i] = m_cells[i];
+            if (!m_headless) buildCell(i);
+            m_dirty_count++;
+        }
+    }
+    std::fill(m_cells.begin(), m_cells.end(), CELL_BLANK);
+
+    if (m_headless) return 0;
+
+    if (m_p_texture != nullptr) {
+        m_p_texture->draw(m_vertices, &m_font.getTexture(m_char_size));
+        m_p_texture->display();
+        m_p_texture->clear();
+        return 0;
+    }
+    m_p_window->draw(m_vertices, &m_font.getTexture(m_char_size));
+    Clock clock;
     m_p_window->display();
+    m_swap_wait = clock.delta();
     m_p_window->clear();
     return 0;
 }
 
+Cell DisplayManager::getCell(int x, int y) const {
+    if (x < 0 || x >= getHorizontal() || y < 0 || y >= getVertical()) {
+        return CELL_BLANK;
+    }
+    return m_cells[y * getHorizontal() + x];
+}
+
+int DisplayManager::getDirtyCount() const {
+    return m_dirty_count;
+}
+
+void DisplayManager::resetCells() {
+    int count = getHorizontal() * getVertical();
+    m_cells.assign(count, CELL_BLANK);
+    m_shown.assign(count, CELL_BLANK);
+    m_dirty_count = 0;
+    if (m_headless) return; // no geometry needed
+    m_vertices.resize(count * VERTICES_PER_CELL);
+    for (int i = 0; i < count; i++) {
+        buildCell(i);
+    }
+}
+
+// Background is a quad textured from the atlas' reserved white pixel, so
+// background and glyph share one texture and one draw call. Placement
+// matches sf::Text: baseline one character size below top. Blank glyphs
+// get a zero-area quad so every cell keeps the same vertex count.
+void DisplayManager::buildCell(int index) {
+    const Cell &cell = m_shown[index];
+    int at = index * VERTICES_PER_CELL;
+    Vector pixel_pos = spacesToPixels(Vector((float)(index % getHorizontal()),
+                                             (float)(index / getHorizontal())));
+    float x = pixel_pos.getX();
+    float y = pixel_pos.getY();
+    float w = charWidth();
+    float h = charHeight();
+
+    // Background rectangle so characters aren't transparent
+    float bg_left = x - w / 10.0f;
+    float bg_top  = y + h / 5.0f;
+    setQuad(m_vertices, at, toSFMLColor(cell.bg),
+            bg_left, bg_top, bg_left + w, bg_top + h,
+            1.0f, 1.0f, 1.0f, 1.0f);
+
+    // Glyph, with a pixel of padding as sf::Text uses
+    const sf::Glyph &glyph = m_glyphs[(unsigned char)cell.ch];
+    if (glyph.textureRect.size.x == 0 || glyph.textureRect.size.y == 0) {
+        setQuad(m_vertices, at + 6, sf::Color::Transparent,
+                x, y, x, y, 0.0f, 0.0f, 0.0f, 0.0f);
+        return;
+    }
+    const float padding = 1.0f;
+    float left   = x + glyph.bounds.position.x - padding;
+    float top    = y + (float)m_char_size + glyph.bounds.position.y - padding;
+    float right  = x + glyph.bounds.position.x + glyph.bounds.size.x + padding;
+    float bottom = y + (float)m_char_size + glyph.bounds.position.y
+                   + glyph.bounds.size.y + padding;
+    float tex_left   = (float)glyph.textureRect.position.x - padding;
+    float tex_top    = (float)glyph.textureRect.position.y - padding;
+    float tex_right  = (float)(glyph.textureRect.position.x + glyph.textureRect.size.x) + padding;
+    float tex_bottom = (float)(glyph.textureRect.position.y + glyph.textureRect.size.y) + padding;
+    setQuad(m_vertices, at + 6, toSFMLColor(cell.fg), left, top, right, bottom,
+            tex_left, tex_top, tex_right, tex_bottom);
+}
+
+int DisplayManager::setHeadless(bool new_headless) {
+    if (isStarted()) return -1;
+    m_headless = new_headless;
+    return 0;
+}
+
+bool DisplayManager::isHeadless() const {
+    return m_headless;
+}
+
+int DisplayManager::setOffscreen(bool new_offscreen) {
+    if (isStarted()) return -1;
+    m_offscreen = new_offscreen;
+    return 0;
+}
+
+bool DisplayManager::isOffscreen() const {
+    return m_offscreen;
+}
+
+void DisplayManager::setVerticalSync(bool new_vsync) {
+    m_vsync = new_vsync;
+    if (m_p_window != nullptr) {
+        m_p_window->setVerticalSyncEnabled(m_vsync);
+    }
+}
+
+bool DisplayManager::isVerticalSync() const {
+    return m_vsync && m_p_window != nullptr;
+}
+
+long int DisplayManager::getSwapWait() const {
+    return m_swap_wait;
+}
+
 sf::RenderWindow *DisplayManager::getWindow() const {
     return m_p_window;
 }
@@ -92,49 +298,23 @@ Vector DisplayManager::pixelsToSpaces(Vector pixels) const {
     return Vector(pixels.getX() / charWidth(), pixels.getY() / charHeight());
 }
 
-int DisplayManager::drawCh(Vector world_pos, char ch, Color color) const {
-    if (m_p_window == nullptr) return -1;
-
-    Vector pixel_pos = spacesToPixels(world_pos);
-
-    // Draw background rectangle so characters aren't transparent
-    static sf::RectangleShape rectangle;
-    rectangle.setSize(sf::Vector2f(charWidth(), charHeight()));
-    rectangle.setFillColor(WINDOW_BACKGROUND_COLOR_DEFAULT);
-    rectangle.setPosition({pixel_pos.getX() - charWidth() / 10.0f,
-                           pixel_pos.getY() + charHeight() / 5.0f});
-    m_p_window->draw(rectangle);
+int DisplayManager::drawCh(Vector pos, char ch, Color color,
+                           Color background, bool in_view) const {
+    if (!isStarted()) return -1;
 
-    // SFML 3: sf::Text(font) takes const sf::Font& - no need for const_cast
-    // We keep a static text and update it each call
-    static sf::Text text(m_font);
-    text.setString(ch);
-    text.setStyle(sf::Text::Bold);
-
-    if (charWidth() < charHeight())
-        text.setCharacterSize((unsigned int)(charWidth() * 2));
-    else
-        text.setCharacterSize((unsigned int)(charHeight() * 2));
-
-    switch (color) {
-    case YELLOW:  text.setFillColor(sf::Color::Yellow);  break;
-    case RED:     text.setFillColor(sf::Color::Red);     break;
-    case BLACK:   text.setFillColor(sf::Color::Black);   break;
-    case GREEN:   text.setFillColor(sf::Color::Green);   break;
-    case BLUE:    text.setFillColor(sf::Color::Blue);    break;
-    case MAGENTA: text.setFillColor(sf::Color::Magenta); break;
-    case CYAN:    text.setFillColor(sf::Color::Cyan);    break;
-    case WHITE:
-    default:      text.setFillColor(sf::Color::White);   break;
+    Vector view_pos = in_view ? pos : WM.worldToView(pos);
+    int x = (int)std::floor(view_pos.getX());
+    int y = (int)std::floor(view_pos.getY());
+    if (x < 0 || x >= getHorizontal() || y < 0 || y >= getVertical()) {
+        return 0; // clipped
     }
-
-    text.setPosition({pixel_pos.getX(), pixel_pos.getY()});
-    m_p_window->draw(text);
+    m_cells[y * getHorizontal() + x] = {ch, color, background};
     return 0;
 }
 
 int DisplayManager::drawString(Vector pos, std::string str,
-                               Justifications justif, Color color) const {
+                               Justifications justif, Color color,
+                               bool in_view) const {
     Vector start = pos;
     switch (justif) {
     case CENTER_JUSTIFIED: start.setX(pos.getX() - (float)str.size() / 2.0f); break;
@@ -142,7 +322,7 @@ int DisplayManager::drawString(Vector pos, std::string str,
     default: break;
     }
     for (int i = 0; i < (int)str.size(); i++) {
-        drawCh(Vector(start.getX() + i, start.getY()), str[i], color);
+        drawCh(Vector(start.getX() + i, start.getY()), str[i], color, BLACK, in_view);
     }
     return 0;
 }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <vector>
 #include <SFML/Graphics.hpp>
 #include "Color.h"
 #include "Manager.h"
@@ -24,6 +25,21 @@ enum Justifications {
     RIGHT_JUSTIFIED,
 };
 
+// One character cell of the display framebuffer
+struct Cell {
+    char ch;         // Character (' ' if nothing drawn)
+    Color fg;        // Foreground (glyph) color
+    Color bg;        // Background color
+
+    bool operator==(const Cell &other) const {
+        return ch == other.ch && fg == other.fg && bg == other.bg;
+    }
+    bool operator!=(const Cell &other) const { return !(*this == other); }
+};
+
+// Cell with nothing drawn in it
+const Cell CELL_BLANK = {' ', COLOR_DEFAULT, BLACK};
+
 class DisplayManager : public Manager {
 private:
     DisplayManager();                              // Private (singleton)
@@ -32,22 +48,68 @@ private:
 
     sf::Font m_font;                   // Font used for ASCII graphics
     sf::RenderWindow *m_p_window;      // Pointer to SFML window
+    sf::RenderTexture *m_p_texture;    // Offscreen target (instead of a window)
+    bool m_headless;                   // True if running without a window
+    bool m_offscreen;                  // True if rendering to m_p_texture
+    bool m_vsync;                      // True if display() waits for vertical sync
+    long int m_swap_wait;              // Microseconds last display() blocked
+    unsigned int m_char_size;          // Glyph size (pixels) in font atlas
+    sf::Glyph m_glyphs[256];           // Glyphs pre-rasterised into atlas
+    mutable std::vector<Cell> m_cells; // Cells drawn this frame (row-major)
+    std::vector<Cell> m_shown;         // Cells shown last frame
+    sf::VertexArray m_vertices;        // Quads for every cell, 12 vertices each
+    int m_dirty_count;                 // Cells rebuilt by last swapBuffers()
     int m_window_horizontal_pixels;    // Horizontal pixels in window
     int m_window_vertical_pixels;      // Vertical pixels in window
     int m_window_horizontal_chars;     // Horizontal ASCII spaces in window
     int m_window_vertical_chars;       // Vertical ASCII spaces in window
 
+    // Size framebuffer and geometry to window, all cells blank
+    void resetCells();
+
+    // Rebuild the background and glyph quads of cell at index
+    void buildCell(int index);
+
 public:
     // Get the one and only instance of the DisplayManager
     static DisplayManager &getInstance();
 
-    // Open graphics window, ready for text-based display
+    // Open graphics window, ready for text-based display.
+    // When headless, no window or font is created: drawing only fills
+    // the cell framebuffer.
     // Return 0 if ok, else -1
     int startUp();
 
     // Close graphics window
     void shutDown();
 
+    // Choose headless mode (no window) for the next startUp()
+    // Return 0 if ok, -1 if already started
+    int setHeadless(bool new_headless = true);
+
+    // Return true if running without a window
+    bool isHeadless() const;
+
+    // Choose offscreen mode for the next startUp(): frames are rendered
+    // as usual, into a texture the size of the window, but no window is
+    // opened (benchmarks and machines without a display; an OpenGL
+    // context is still needed)
+    // Return 0 if ok, -1 if already started
+    int setOffscreen(bool new_offscreen = true);
+
+    // Return true if rendering into a texture instead of a window
+    bool isOffscreen() const;
+
+    // Set whether the window waits for vertical sync (default true)
+    void setVerticalSync(bool new_vsync = true);
+
+    // Return true if a window is open with vertical sync requested
+    bool isVerticalSync() const;
+
+    // Return microseconds the last swapBuffers() spent in display(),
+    // i.e. waiting for vertical sync when the driver honours it
+    long int getSwapWait() const;
+
     // Return window's horizontal maximum (in characters)
     int getHorizontal() const;
 
@@ -60,20 +122,38 @@ public:
     // Return window's vertical maximum (in pixels)
     int getVerticalPixels() const;
 
-    // Render current window buffer to screen
+    // Rebuild geometry of cells that differ from last frame, render all
+    // cells in one draw call, display window and blank cells for next frame.
+    // When headless, only captures the frame (no rendering, no vsync wait).
     // Return 0 if ok, else -1
     int swapBuffers();
 
-    // Return pointer to SFML graphics window
+    // Return cell (x,y) of the window drawn so far this frame, CELL_BLANK
+    // if out of range
+    Cell getCell(int x, int y) const;
+
+    // Return number of cells whose geometry last swapBuffers() rebuilt
+    int getDirtyCount() const;
+
+    // Return pointer to SFML graphics window (nullptr when headless or
+    // offscreen)
     sf::RenderWindow *getWindow() const;
 
-    // Draw a character at window location (x,y) with color
+    // Draw a character at world location (x,y) with color into the
+    // framebuffer cell containing it, after translating it to the view
+    // (WM.worldToView(); off-window cells are clipped). If in_view, the
+    // location is already in view (window) spaces and is not translated,
+    // so it stays put as the view moves (HUDs, menus).
+    // Shown on screen by swapBuffers().
     // Return 0 if ok, else -1
-    int drawCh(Vector world_pos, char ch, Color color) const;
+    int drawCh(Vector pos, char ch, Color color,
+               Color background = BLACK, bool in_view = false) const;
 
-    // Draw string at position with justification and color
+    // Draw string at position with justification and color (in view
+    // spaces if in_view, as for drawCh())
     // Return 0 if ok, else -1
-    int drawString(Vector pos, std::string str, Justifications justif, Color color) const;
+    int drawString(Vector pos, std::string str, Justifications justif, Color color,
+                   bool in_view = false) const;
 
     // Compute character height in pixels
     float charHeight() const;
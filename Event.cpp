@@ -1,17 +1,107 @@
 #include "Event.h"
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
 
 namespace df {
 
-Event::Event() : m_event_type(UNDEFINED_EVENT) {}
+// Event type name table. Names are stored in fixed-size chunks that are
+// never moved or freed, and published with an atomic count, so
+// typeName() reads them without locking (it is called from parallel step
+// handlers). Only registering a new name takes the mutex.
+namespace {
+
+const int NAME_CHUNK_SIZE = 64;    // Names per chunk
+const int NAME_CHUNKS_MAX = 1024;  // Chunks (so at most 65536 types)
+
+struct EventTypeRegistry {
+    std::mutex mutex;                              // Held to add names
+    std::atomic<std::string *> chunks[NAME_CHUNKS_MAX]; // Names by id
+    std::atomic<int> count;                        // Names published
+    std::unordered_map<std::string, int> ids;      // Name to id (mutex)
+
+    EventTypeRegistry() : count(0) {
+        for (std::atomic<std::string *> &chunk : chunks) {
+            chunk.store(nullptr, std::memory_order_relaxed);
+        }
+        // Order must match BuiltinEventId (names match the *_EVENT constants)
+        const char *builtin[] = {
+            "df::undefined", "df::step", "df::collision",
+            "df::out", "df::keyboard", "df::mouse",
+        };
+        for (const char *name : builtin) {
+            add(name);
+        }
+    }
+
+    // Store name under the next id and publish it (mutex held, or in
+    // constructor)
+    // Return id, -1 if table is full
+    int add(const std::string &name) {
+        int id = count.load(std::memory_order_relaxed);
+        int chunk = id / NAME_CHUNK_SIZE;
+        if (chunk >= NAME_CHUNKS_MAX) return -1;
+        std::string *p_chunk = chunks[chunk].load(std::memory_order_relaxed);
+        if (p_chunk == nullptr) {
+            p_chunk = new std::string[NAME_CHUNK_SIZE];
+            chunks[chunk].store(p_chunk, std::memory_order_relaxed);
+        }
+        p_chunk[id % NAME_CHUNK_SIZE] = name;
+        ids[name] = id;
+        count.store(id + 1, std::memory_order_release);
+        return id;
+    }
+};
+
+EventTypeRegistry &registry() {
+    static EventTypeRegistry instance;
+    return instance;
+}
+
+} // end anonymous namespace
+
+Event::Event() : m_event_id(UNDEFINED_EVENT_ID) {}
 
 Event::~Event() {}
 
 void Event::setType(std::string new_type) {
-    m_event_type = new_type;
+    m_event_id = registerType(new_type);
+}
+
+const std::string &Event::getType() const {
+    return typeName(m_event_id);
+}
+
+void Event::setTypeId(int new_id) {
+    m_event_id = new_id;
+}
+
+int Event::getTypeId() const {
+    return m_event_id;
+}
+
+// If the table is full the type is undefined.
+int Event::registerType(const std::string &type) {
+    EventTypeRegistry &r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    auto it = r.ids.find(type);
+    if (it != r.ids.end()) {
+        return it->second;
+    }
+    int id = r.add(type);
+    return id < 0 ? UNDEFINED_EVENT_ID : id;
+}
+
+const std::string &Event::typeName(int id) {
+    EventTypeRegistry &r = registry();
+    if (id < 0 || id >= r.count.load(std::memory_order_acquire)) {
+        return UNDEFINED_EVENT;
+    }
+    return r.chunks[id / NAME_CHUNK_SIZE].load(std::memory_order_relaxed)[id % NAME_CHUNK_SIZE];
 }
 
-std::string Event::getType() const {
-    return m_event_type;
+int Event::typeCount() {
+    return registry().count.load(std::memory_order_acquire);
 }
 
 } // end namespace df
@@ -5,11 +5,23 @@
 // Defined outside namespace for global access
 const std::string UNDEFINED_EVENT = "df::undefined";
 
+// Built-in event type ids, fixed at compile time. User-defined event types
+// are interned to ids from FIRST_USER_EVENT_ID up when first registered.
+enum BuiltinEventId {
+    UNDEFINED_EVENT_ID = 0,
+    STEP_EVENT_ID,
+    COLLISION_EVENT_ID,
+    OUT_EVENT_ID,
+    KEYBOARD_EVENT_ID,
+    MSE_EVENT_ID,
+    FIRST_USER_EVENT_ID,
+};
+
 namespace df {
 
 class Event {
 private:
-    std::string m_event_type; // Holds event type
+    int m_event_id; // Interned event type id
 
 public:
     // Create base event with undefined type
@@ -18,11 +30,26 @@ public:
     // Virtual destructor for proper polymorphism
     virtual ~Event();
 
-    // Set event type
+    // Set event type by name (interns name, registering it if new)
     void setType(std::string new_type);
 
-    // Get event type
-    std::string getType() const;
+    // Get event type name (for logging and legacy comparisons)
+    const std::string &getType() const;
+
+    // Set event type by id
+    void setTypeId(int new_id);
+
+    // Get event type id (compare against *_EVENT_ID or registerType())
+    int getTypeId() const;
+
+    // Return id for event type name, assigning the next free id if new
+    static int registerType(const std::string &type);
+
+    // Return name of event type id, UNDEFINED_EVENT if unknown
+    static const std::string &typeName(int id);
+
+    // Return count of event type ids assigned so far
+    static int typeCount();
 };
 
 } // end namespace df
@@ -12,7 +12,7 @@ EventCollision::EventCollision()
     , m_p_obj1(nullptr)
     , m_p_obj2(nullptr)
 {
-    setType(COLLISION_EVENT);
+    setTypeId(COLLISION_EVENT_ID);
 }
 
 // BUG FIX: Same issue in parameterized constructor - local vars shadowed members.
@@ -21,7 +21,7 @@ EventCollision::EventCollision(Object *p_o1, Object *p_o2, Vector p)
     , m_p_obj1(p_o1)
     , m_p_obj2(p_o2)
 {
-    setType(COLLISION_EVENT);
+    setTypeId(COLLISION_EVENT_ID);
 }
 
 void EventCollision::setObject1(Object *p_new_o1) {
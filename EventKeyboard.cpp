@@ -6,7 +6,7 @@ EventKeyboard::EventKeyboard()
     : m_key_val(UNDEFINED_KEY)
     , m_keyboard_action(UNDEFINED_KEYBOARD_ACTION)
 {
-    setType(KEYBOARD_EVENT);
+    setTypeId(KEYBOARD_EVENT_ID);
 }
 
 void EventKeyboard::setKey(df::Key new_key)            { m_key_val = new_key; }
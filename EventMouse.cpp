@@ -4,13 +4,13 @@ namespace df {
 
 // BUG FIX: Original constructor used "df::Event(MSE_EVENT)" which doesn't
 // call the parent constructor - it constructs a temporary. Fixed to use
-// proper initializer list and setType().
+// proper initializer list and setTypeId().
 EventMouse::EventMouse()
     : m_mouse_action(UNDEFINED_MOUSE_ACTIONS)
     , m_mouse_button(UNDEFINED_MOUSE_BUTTON)
     , m_mouse_xy()
 {
-    setType(MSE_EVENT);
+    setTypeId(MSE_EVENT_ID);
 }
 
 void EventMouse::setMouseAction(EventMouseAction new_mouse_action) {
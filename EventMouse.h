@@ -26,7 +26,7 @@ class EventMouse : public Event {
 private:
     EventMouseAction m_mouse_action; // Mouse action
     df::Button m_mouse_button;       // Mouse button
-    Vector m_mouse_xy;               // Mouse (x,y) coordinates
+    Vector m_mouse_xy;               // Mouse (x,y) world coordinates
 
 public:
     EventMouse();
@@ -43,7 +43,7 @@ public:
     // Get mouse event's button
     df::Button getMouseButton() const;
 
-    // Set mouse event's position
+    // Set mouse event's position (world coordinates)
     void setMousePosition(Vector new_mouse_xy);
 
     // Get mouse event's position
@@ -3,7 +3,7 @@
 namespace df {
 
 EventOut::EventOut() {
-    setType(OUT_EVENT);
+    setTypeId(OUT_EVENT_ID);
 }
 
 } // end namespace df
@@ -3,11 +3,11 @@
 namespace df {
 
 EventStep::EventStep() : m_step_count(0) {
-    setType(STEP_EVENT);
+    setTypeId(STEP_EVENT_ID);
 }
 
 EventStep::EventStep(int init_step_count) : m_step_count(init_step_count) {
-    setType(STEP_EVENT);
+    setTypeId(STEP_EVENT_ID);
 }
 
 void EventStep::setStepCount(int new_step_count) {
@@ -5,16 +5,45 @@
 #include "InputManager.h"
 #include "EventStep.h"
 #include "Clock.h"
+#include "Profiler.h"
+#include "Object.h"
+#include "ObjectListView.h"
+#include <atomic>
 #include <thread>
 #include <chrono>
 
 namespace df {
 
+// Hybrid pacing starts spinning this long before the deadline, on top of
+// the expected oversleep
+static const long int SPIN_MARGIN = 100;
+
+// Starting guess and ceiling for sleep overshoot (microseconds)
+static const long int OVERSLEEP_INITIAL = 1000;
+static const long int OVERSLEEP_MAX = 5000;
+
+// Most thread-safe step handlers one job runs
+static const int STEP_JOB_CHUNK = 64;
+
+// Average display() wait (microseconds) above which vsync is taken to be
+// pacing the loop
+static const long int VSYNC_WAIT_MIN = 1000;
+
 GameManager::GameManager()
     : m_game_over(false)
     , m_frame_time(FRAME_TIME_DEFAULT)
+    , m_render_time(0)
+    , m_max_catch_up(MAX_CATCH_UP_STEPS_DEFAULT)
+    , m_step_count(0)
+    , m_is_stepping(false)
+    , m_alpha(0)
+    , m_pacing(PACE_HYBRID)
+    , m_oversleep(OVERSLEEP_INITIAL)
+    , m_swap_wait_avg(0)
 {
     setType("GameManager");
+    int cores = (int)std::thread::hardware_concurrency();
+    m_worker_count = (cores > 1) ? cores - 1 : 0;
 }
 
 GameManager &GameManager::getInstance() {
@@ -28,75 +57,188 @@ int GameManager::startUp() {
         return -1;
     }
 
-    LM.writeLog("GameManager::startUp() - starting up managers...");
+    DF_LOG_INFO("GameManager::startUp() - starting up managers...");
 
     if (WM.startUp() != 0) {
-        LM.writeLog("GameManager::startUp() - ERROR: WorldManager failed");
+        DF_LOG_ERROR("GameManager::startUp() - WorldManager failed");
         return -1;
     }
 
     if (DM.startUp() != 0) {
-        LM.writeLog("GameManager::startUp() - ERROR: DisplayManager failed");
+        DF_LOG_ERROR("GameManager::startUp() - DisplayManager failed");
         return -1;
     }
 
     if (IM.startUp() != 0) {
-        LM.writeLog("GameManager::startUp() - ERROR: InputManager failed");
+        DF_LOG_ERROR("GameManager::startUp() - InputManager failed");
         return -1;
     }
 
-    LM.writeLog("GameManager::startUp() - all managers started OK");
+    if (m_jobs.startUp(m_worker_count) != 0) {
+        DF_LOG_ERROR("GameManager::startUp() - job threads failed");
+        return -1;
+    }
+
+    DF_LOG_INFO("GameManager::startUp() - all managers started OK (%d job threads)",
+                m_worker_count);
     return Manager::startUp();
 }
 
 void GameManager::shutDown() {
-    LM.writeLog("GameManager::shutDown() - shutting down managers...");
+    DF_LOG_INFO("GameManager::shutDown() - shutting down managers...");
     IM.shutDown();
     DM.shutDown();
     WM.shutDown();
+    m_jobs.shutDown();
     Manager::shutDown();
-    LM.writeLog("GameManager::shutDown() - done");
+    DF_LOG_INFO("GameManager::shutDown() - done");
     LM.shutDown();
 }
 
+void GameManager::step() {
+    DF_PROFILE_SCOPE("step");
+    m_is_stepping = true;
+
+    // -- UPDATE: send step event to all Objects --
+    {
+        DF_PROFILE_SCOPE("step event");
+        EventStep step(m_step_count++);
+        dispatchStep(&step);
+    }
+
+    // -- UPDATE: move objects, check collisions --
+    {
+        DF_PROFILE_SCOPE("WM.update");
+        WM.update();
+    }
+
+    m_is_stepping = false;
+}
+
+// Thread-safe handlers go first so the ordered ones see every parallel
+// result, and an ordered handler can't delete an Object a job is stepping.
+int GameManager::dispatchStep(const EventStep *p_step) {
+    ObjectList *p_list = getInterestList(STEP_EVENT_ID);
+    if (p_list == nullptr) return 0;
+
+    m_parallel_steps.clear();
+    for (Object *p_o : ObjectListView(*p_list)) {
+        if (p_o->isStepThreadSafe()) m_parallel_steps.push_back(p_o);
+    }
+    std::atomic<int> handled(0);
+    if (!m_parallel_steps.empty()) {
+        DF_PROFILE_SCOPE("parallel step");
+        m_jobs.parallelFor((int)m_parallel_steps.size(), STEP_JOB_CHUNK,
+                           [&](int begin, int end) {
+            int count = 0;
+            for (int i = begin; i < end; i++) {
+                count += m_parallel_steps[i]->eventHandler(p_step);
+            }
+            handled += count;
+        });
+    }
+
+    int count = handled;
+    for (Object *p_o : ObjectListView(*p_list)) {
+        if (!p_o->isStepThreadSafe()) count += p_o->eventHandler(p_step);
+    }
+    return count;
+}
+
 void GameManager::run() {
     Clock clock;
-    int step_count = 0;
+    int start_steps = m_step_count;
 
-    LM.writeLog("GameManager::run() - entering game loop at %d Hz",
+    DF_LOG_INFO("GameManager::run() - entering game loop at %d Hz",
                 1000000 / m_frame_time);
 
+    // Owed simulation time; start one step due so the first frame steps
+    long int accumulator = m_frame_time;
+    clock.delta();
+
     while (!m_game_over) {
-        clock.delta(); // mark frame start
+        DF_PROFILE_FRAME();
+        DF_PROFILE_SCOPE("frame");
+        accumulator += clock.delta(); // time since last frame started
 
         // -- INPUT --
-        IM.getInput();
-
-        // -- UPDATE: send step event to all Objects --
-        EventStep step(step_count++);
-        onEvent(&step);
+        {
+            DF_PROFILE_SCOPE("IM.getInput");
+            IM.getInput();
+        }
 
-        // -- UPDATE: move objects, check collisions --
-        WM.update();
+        // -- UPDATE: whole steps due, up to the catch-up limit --
+        int steps = 0;
+        while (!m_game_over && accumulator >= m_frame_time && steps < m_max_catch_up) {
+            step();
+            accumulator -= m_frame_time;
+            steps++;
+        }
+        if (accumulator >= m_frame_time) {
+            DF_LOG_DEBUG("GameManager::run() - dropped %ld us behind after %d steps",
+                         accumulator - accumulator % m_frame_time, steps);
+            accumulator %= m_frame_time;
+        }
+        // Rendering once per step draws just after it, so at the step's
+        // positions rather than (almost) a whole step behind
+        m_alpha = m_render_time > 0 ? (float)accumulator / (float)m_frame_time : 1.0f;
 
         // -- DRAW: all objects draw themselves --
-        WM.draw();
+        {
+            DF_PROFILE_SCOPE("WM.draw");
+            WM.draw();
+        }
 
         // -- SWAP: refresh screen --
-        DM.swapBuffers();
+        {
+            DF_PROFILE_SCOPE("DM.swapBuffers");
+            DM.swapBuffers();
+        }
+        m_swap_wait_avg += (DM.getSwapWait() - m_swap_wait_avg) / 8;
 
-        // -- TIMING: sleep remaining time to hit target frame rate --
-        long int elapsed = clock.split();
-        long int sleep_time = m_frame_time - elapsed;
-        if (sleep_time > 0) {
-            std::this_thread::sleep_for(std::chrono::microseconds(sleep_time));
+        // -- TIMING: wait until next step or rendered frame is due,
+        // unless vsync already waited in swapBuffers() --
+        if (isVsyncPacing()) {
+            continue;
         }
+        long int target = m_frame_time - accumulator;
+        if (m_render_time > 0 && m_render_time < target) {
+            target = m_render_time;
+        }
+        DF_PROFILE_SCOPE("wait");
+        waitUntil(clock, target);
+    }
 
-        // Drain elapsed time to start fresh for next frame
-        clock.delta();
+    DF_LOG_INFO("GameManager::run() - exited game loop after %d steps",
+                m_step_count - start_steps);
+}
+
+void GameManager::waitUntil(const Clock &clock, long int target) {
+    long int remaining = target - clock.split();
+    if (remaining <= 0) {
+        return;
+    }
+    if (m_pacing == PACE_SLEEP) {
+        std::this_thread::sleep_for(std::chrono::microseconds(remaining));
+        return;
     }
 
-    LM.writeLog("GameManager::run() - exited game loop after %d steps", step_count);
+    // Sleep short by the expected overshoot, then correct the estimate:
+    // up at once if worse, down slowly if better
+    long int coarse = remaining - m_oversleep - SPIN_MARGIN;
+    if (coarse > 0) {
+        long int before = clock.split();
+        std::this_thread::sleep_for(std::chrono::microseconds(coarse));
+        long int over = clock.split() - before - coarse;
+        if (over > m_oversleep) {
+            m_oversleep = (over < OVERSLEEP_MAX) ? over : OVERSLEEP_MAX;
+        } else if (over > 0) {
+            m_oversleep -= (m_oversleep - over) / 16;
+        }
+    }
+    while (clock.split() < target) {
+        std::this_thread::yield();
+    }
 }
 
 void GameManager::setGameOver(bool new_game_over) {
@@ -115,4 +257,71 @@ int GameManager::getFrameTime() const {
     return m_frame_time;
 }
 
+void GameManager::setRenderTime(int new_render_time) {
+    m_render_time = new_render_time;
+}
+
+int GameManager::getRenderTime() const {
+    return m_render_time;
+}
+
+int GameManager::setMaxCatchUpSteps(int new_max_catch_up) {
+    if (new_max_catch_up < 1) {
+        return -1;
+    }
+    m_max_catch_up = new_max_catch_up;
+    return 0;
+}
+
+int GameManager::getMaxCatchUpSteps() const {
+    return m_max_catch_up;
+}
+
+int GameManager::getStepCount() const {
+    return m_step_count;
+}
+
+void GameManager::setPacing(FramePacing new_pacing) {
+    m_pacing = new_pacing;
+}
+
+FramePacing GameManager::getPacing() const {
+    return m_pacing;
+}
+
+long int GameManager::getOversleep() const {
+    return m_oversleep;
+}
+
+bool GameManager::isVsyncPacing() const {
+    return DM.isVerticalSync() && m_swap_wait_avg >= VSYNC_WAIT_MIN;
+}
+
+int GameManager::setWorkerCount(int new_worker_count) {
+    if (new_worker_count < 0) {
+        return -1;
+    }
+    m_worker_count = new_worker_count;
+    if (isStarted()) {
+        return m_jobs.startUp(m_worker_count);
+    }
+    return 0;
+}
+
+int GameManager::getWorkerCount() const {
+    return m_worker_count;
+}
+
+JobSystem &GameManager::getJobs() {
+    return m_jobs;
+}
+
+bool GameManager::isStepping() const {
+    return m_is_stepping;
+}
+
+float GameManager::getAlpha() const {
+    return m_alpha;
+}
+
 } // end namespace df
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <vector>
+#include "Clock.h"
+#include "JobSystem.h"
 #include "Manager.h"
 
 #define GM df::GameManager::getInstance()
@@ -7,12 +10,46 @@
 // Default game loop target (steps per second)
 const int FRAME_TIME_DEFAULT = 33333; // ~30 Hz in microseconds
 
+// Most simulation steps run in one frame to catch up after a slow frame
+const int MAX_CATCH_UP_STEPS_DEFAULT = 5;
+
 namespace df {
 
+class EventStep;
+
+// How the game loop waits for the next step or frame
+enum FramePacing {
+    PACE_SLEEP,   // Sleep the whole wait (cheap, but oversleeps)
+    PACE_HYBRID,  // Sleep most of the wait, then spin to the deadline
+};
+
 class GameManager : public Manager {
 private:
     bool m_game_over;   // True when game loop should end
-    int m_frame_time;   // Target microseconds per frame
+    int m_frame_time;   // Microseconds per simulation step
+    int m_render_time;  // Microseconds per rendered frame (0 = once per step)
+    int m_max_catch_up; // Most steps run in one frame
+    int m_step_count;   // Simulation steps run so far
+    bool m_is_stepping; // True while a simulation step runs
+    float m_alpha;      // Fraction of a step elapsed since the last one
+    FramePacing m_pacing;      // How waits are done
+    long int m_oversleep;      // Estimated sleep overshoot (microseconds)
+    long int m_swap_wait_avg;  // Smoothed time display() blocks (microseconds)
+    int m_worker_count;        // Job threads started by startUp()
+    JobSystem m_jobs;          // Job threads for parallel work
+    std::vector<Object *> m_parallel_steps; // Thread-safe Objects stepped this step
+
+    // Run one simulation step: step event, then move objects
+    void step();
+
+    // Send step event: thread-safe Objects in parallel, then the rest in
+    // interest order
+    // Return number of objects that handled the event
+    int dispatchStep(const EventStep *p_step);
+
+    // Wait until clock.split() reaches target (microseconds), as the
+    // pacing mode says. Hybrid waits learn how far sleeps overshoot.
+    void waitUntil(const Clock &clock, long int target);
 
     GameManager();                           // Private (singleton)
     GameManager(GameManager const &);        // No copy
@@ -29,7 +66,9 @@ public:
     // Shut down all managers in reverse order
     void shutDown();
 
-    // Run the game loop until game over
+    // Run the game loop until game over. The simulation advances in
+    // fixed steps of frame time (as many as are due, up to the catch-up
+    // limit); input, drawing and swapping happen once per frame.
     void run();
 
     // Set game over flag to stop the loop
@@ -38,11 +77,62 @@ public:
     // Get game over state
     bool getGameOver() const;
 
-    // Set target frame time (microseconds)
+    // Set simulation step time (microseconds)
     void setFrameTime(int new_frame_time);
 
-    // Get target frame time (microseconds)
+    // Get simulation step time (microseconds)
     int getFrameTime() const;
+
+    // Set time per rendered frame (microseconds). 0 renders once per step;
+    // less than frame time renders in between, with interpolated positions.
+    // Vsync may hold rendering to the display rate.
+    void setRenderTime(int new_render_time);
+
+    // Get time per rendered frame (microseconds)
+    int getRenderTime() const;
+
+    // Set most simulation steps run in one frame. Time still owed past
+    // that is dropped, so the game slows down rather than spiralling.
+    // Return 0 if ok, else -1 (less than 1).
+    int setMaxCatchUpSteps(int new_max_catch_up);
+
+    // Get most simulation steps run in one frame
+    int getMaxCatchUpSteps() const;
+
+    // Get count of simulation steps run so far (including one running)
+    int getStepCount() const;
+
+    // Return true while a simulation step is running
+    bool isStepping() const;
+
+    // Set how the loop waits between frames (default PACE_HYBRID)
+    void setPacing(FramePacing new_pacing);
+
+    // Get how the loop waits between frames
+    FramePacing getPacing() const;
+
+    // Get current estimate of sleep overshoot (microseconds)
+    long int getOversleep() const;
+
+    // Return true if vertical sync is pacing the loop: the window waits
+    // for it and display() is seen blocking, so the loop does not wait too
+    bool isVsyncPacing() const;
+
+    // Set count of job threads (default: one per core after the first).
+    // Restarts the job threads if already started.
+    // Return 0 if ok, else -1 (negative).
+    int setWorkerCount(int new_worker_count);
+
+    // Get count of job threads
+    int getWorkerCount() const;
+
+    // Return job system, for spreading work over the job threads
+    JobSystem &getJobs();
+
+    // Get interpolation factor for drawing: fraction [0, 1) of a step
+    // elapsed since the last step ran, or 1 when rendering once per step
+    // (render time 0), so Objects draw where the step left them
+    float getAlpha() const;
 };
 
 } // end namespace df
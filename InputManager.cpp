@@ -5,7 +5,6 @@
 #include "LogManager.h"
 #include "Manager.h"
 #include "WorldManager.h"
-#include "Object.h"
 #include <SFML/Graphics.hpp>
 #include <optional>
 
@@ -22,33 +21,47 @@ InputManager &InputManager::getInstance() {
 
 int InputManager::startUp() {
     if (!DM.isStarted()) {
-        LM.writeLog("InputManager::startUp() - DisplayManager not started");
+        DF_LOG_ERROR("InputManager::startUp() - DisplayManager not started");
         return -1;
     }
-    LM.writeLog("InputManager::startUp() - OK");
+    DF_LOG_INFO("InputManager::startUp() - OK");
     return Manager::startUp();
 }
 
 void InputManager::shutDown() {
+    m_injected.clear();
     Manager::shutDown();
-    LM.writeLog("InputManager::shutDown() - OK");
+    DF_LOG_INFO("InputManager::shutDown() - OK");
 }
 
-// Helper: broadcast a df event to all world objects
-static void broadcast(const df::Event *p_e) {
-    ObjectList all = WM.getAllObjects();
-    for (int i = 0; i < all.getCount(); i++) {
-        all[i]->eventHandler(p_e);
-    }
+void InputManager::pushEvent(const EventKeyboard &event) {
+    m_injected.push_back(event);
+}
+
+void InputManager::pushEvent(const EventMouse &event) {
+    m_injected.push_back(event);
 }
 
 // SFML 3 completely redesigned its event system:
 // - pollEvent() returns std::optional<sf::Event> (no out-param)
 // - Events accessed via event->getIf<sf::Event::KeyPressed>() etc.
 // - Mouse buttons are sf::Mouse::Button::Left/Right/Middle
-void InputManager::getInput() const {
+void InputManager::getInput() {
+    // Injected events first. Handlers may inject more; those wait for the
+    // next call.
+    size_t injected = m_injected.size();
+    for (size_t i = 0; i < injected; i++) {
+        std::variant<EventKeyboard, EventMouse> event = m_injected.front();
+        m_injected.pop_front();
+        if (const EventKeyboard *p_ek = std::get_if<EventKeyboard>(&event)) {
+            onEvent(p_ek);
+        } else {
+            onEvent(&std::get<EventMouse>(event));
+        }
+    }
+
     sf::RenderWindow *p_window = DM.getWindow();
-    if (p_window == nullptr) return;
+    if (p_window == nullptr) return; // headless
 
     while (auto event = p_window->pollEvent()) {
 
@@ -62,7 +75,7 @@ void InputManager::getInput() const {
             EventKeyboard ek;
             ek.setKeyboardAction(KEY_PRESSED);
             ek.setKey(EventKeyboard::convertFromSFML(kp->code));
-            broadcast(&ek);
+            onEvent(&ek);
         }
 
         // Key released
@@ -70,7 +83,7 @@ void InputManager::getInput() const {
             EventKeyboard ek;
             ek.setKeyboardAction(KEY_RELEASED);
             ek.setKey(EventKeyboard::convertFromSFML(kr->code));
-            broadcast(&ek);
+            onEvent(&ek);
         }
 
         // Mouse button pressed
@@ -83,10 +96,10 @@ void InputManager::getInput() const {
                 em.setMouseButton(df::RIGHT);
             else
                 em.setMouseButton(df::MIDDLE);
-            Vector mouse_pos = DM.pixelsToSpaces(
-                Vector((float)mb->position.x, (float)mb->position.y));
+            Vector mouse_pos = WM.viewToWorld(DM.pixelsToSpaces(
+                Vector((float)mb->position.x, (float)mb->position.y)));
             em.setMousePosition(mouse_pos);
-            broadcast(&em);
+            onEvent(&em);
         }
 
         // Mouse moved
@@ -94,10 +107,10 @@ void InputManager::getInput() const {
             EventMouse em;
             em.setMouseAction(MOVED);
             em.setMouseButton(df::UNDEFINED_MOUSE_BUTTON);
-            Vector mouse_pos = DM.pixelsToSpaces(
-                Vector((float)mm->position.x, (float)mm->position.y));
+            Vector mouse_pos = WM.viewToWorld(DM.pixelsToSpaces(
+                Vector((float)mm->position.x, (float)mm->position.y)));
             em.setMousePosition(mouse_pos);
-            broadcast(&em);
+            onEvent(&em);
         }
     }
 }
@@ -1,6 +1,10 @@
 #pragma once
 
+#include <deque>
+#include <variant>
 #include "Manager.h"
+#include "EventKeyboard.h"
+#include "EventMouse.h"
 
 #define IM df::InputManager::getInstance()
 
@@ -12,19 +16,30 @@ private:
     InputManager(InputManager const &);          // No copy
     void operator=(InputManager const &);        // No assign
 
+    // Injected input waiting for the next getInput()
+    std::deque<std::variant<EventKeyboard, EventMouse>> m_injected;
+
 public:
     // Get the one and only instance of the InputManager
     static InputManager &getInstance();
 
-    // Get window ready to capture input
+    // Get window ready to capture input (needs DisplayManager started,
+    // headless or not)
     // Return 0 if ok, else -1
     int startUp();
 
     // Revert back to normal window mode
     void shutDown();
 
-    // Get input from keyboard and mouse, pass event to all Objects
-    void getInput() const;
+    // Queue keyboard or mouse event as if it came from the window.
+    // Delivered, in order, by the next getInput(). Used for headless
+    // runs, replays and tests.
+    void pushEvent(const EventKeyboard &event);
+    void pushEvent(const EventMouse &event);
+
+    // Get injected input, then input from window keyboard and mouse (if
+    // any), and pass events to interested Objects
+    void getInput();
 };
 
 } // end namespace df
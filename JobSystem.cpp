@@ -0,0 +1,132 @@
+#include "JobSystem.h"
+
+namespace df {
+
+JobSystem::JobSystem()
+    : m_running(false)
+    , m_queued(0)
+    , m_unfinished(0)
+    , m_stolen(0)
+{
+    m_queues.emplace_back(new JobQueue());
+}
+
+JobSystem::~JobSystem() {
+    shutDown();
+}
+
+int JobSystem::startUp(int worker_count) {
+    if (worker_count < 0) return -1;
+    shutDown();
+    m_running = true;
+    for (int i = 1; i <= worker_count; i++) {
+        m_queues.emplace_back(new JobQueue());
+    }
+    for (int i = 1; i <= worker_count; i++) {
+        m_workers.emplace_back(&JobSystem::workerLoop, this, i);
+    }
+    return 0;
+}
+
+void JobSystem::shutDown() {
+    {
+        std::lock_guard<std::mutex> lock(m_wake_mutex);
+        m_running = false;
+    }
+    m_wake.notify_all();
+    for (std::thread &worker : m_workers) {
+        worker.join();
+    }
+    m_workers.clear();
+    m_queues.resize(1);
+}
+
+int JobSystem::getWorkerCount() const {
+    return (int)m_workers.size();
+}
+
+long int JobSystem::getStolen() const {
+    return m_stolen;
+}
+
+bool JobSystem::takeJob(int index, Job &job) {
+    {
+        JobQueue &own = *m_queues[index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.jobs.empty()) {
+            job = own.jobs.back();
+            own.jobs.pop_back();
+            m_queued--;
+            return true;
+        }
+    }
+    int count = (int)m_queues.size();
+    for (int i = 1; i < count; i++) {
+        JobQueue &victim = *m_queues[(index + i) % count];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.jobs.empty()) {
+            job = victim.jobs.front();
+            victim.jobs.pop_front();
+            m_queued--;
+            m_stolen++;
+            return true;
+        }
+    }
+    return false;
+}
+
+void JobSystem::runJob(const Job &job) {
+    (*job.p_fn)(job.begin, job.end);
+    m_unfinished.fetch_sub(1, std::memory_order_release);
+}
+
+void JobSystem::workerLoop(int index) {
+    Job job;
+    for (;;) {
+        if (takeJob(index, job)) {
+            runJob(job);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(m_wake_mutex);
+        m_wake.wait(lock, [this] { return m_queued > 0 || !m_running; });
+        if (!m_running) return;
+    }
+}
+
+// Chunks are dealt round-robin so every thread starts with local work;
+// the caller then helps until its queue and everyone else's are empty,
+// and waits for jobs still running elsewhere.
+void JobSystem::parallelFor(int count, int chunk, const JobRange &fn) {
+    if (count <= 0) return;
+    if (chunk < 1) chunk = 1;
+    if (m_workers.empty() || count <= chunk) {
+        fn(0, count);
+        return;
+    }
+
+    int queue_count = (int)m_queues.size();
+    int jobs = (count + chunk - 1) / chunk;
+    m_unfinished = jobs;
+    for (int j = 0; j < jobs; j++) {
+        int begin = j * chunk;
+        int end = (begin + chunk < count) ? begin + chunk : count;
+        JobQueue &queue = *m_queues[j % queue_count];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.jobs.push_back(Job{&fn, begin, end});
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_wake_mutex);
+        m_queued += jobs;
+    }
+    m_wake.notify_all();
+
+    Job job;
+    while (takeJob(0, job)) {
+        runJob(job);
+    }
+    while (m_unfinished.load(std::memory_order_acquire) > 0) {
+        std::this_thread::yield();
+    }
+}
+
+} // end namespace df
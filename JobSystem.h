@@ -0,0 +1,82 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace df {
+
+// Range of indices [begin, end) a job works on
+typedef std::function<void(int begin, int end)> JobRange;
+
+// Thread pool for data-parallel loops. parallelFor() splits a range into
+// chunks spread over per-thread queues; each thread works its own queue
+// from the back and steals from the front of the others' when it runs
+// dry, so uneven chunks even out. The calling thread works too.
+// parallelFor() is meant to be called from one thread (the game loop),
+// and not from inside a job.
+class JobSystem {
+private:
+    // Chunk of a parallelFor() range
+    struct Job {
+        const JobRange *p_fn;  // Function to run on the chunk
+        int begin;             // First index
+        int end;               // One past last index
+    };
+
+    // Jobs queued for one thread (index 0 is the caller's)
+    struct JobQueue {
+        std::mutex mutex;
+        std::deque<Job> jobs;
+    };
+
+    std::vector<std::unique_ptr<JobQueue>> m_queues; // Caller's, then workers'
+    std::vector<std::thread> m_workers;   // Worker threads
+    std::mutex m_wake_mutex;              // Guards sleeping on m_wake
+    std::condition_variable m_wake;       // Signalled when jobs are queued
+    std::atomic<bool> m_running;          // False asks workers to exit
+    std::atomic<int> m_queued;            // Jobs waiting in queues
+    std::atomic<int> m_unfinished;        // Jobs of this parallelFor() not done
+    std::atomic<long int> m_stolen;       // Jobs run by a thread they weren't queued for
+
+    JobSystem(JobSystem const &);         // No copy
+    void operator=(JobSystem const &);    // No assign
+
+    // Take a job for thread index: own queue first, then steal
+    // Return true if got one
+    bool takeJob(int index, Job &job);
+
+    // Run job and count it done
+    void runJob(const Job &job);
+
+    // Worker thread: run jobs until stopped
+    void workerLoop(int index);
+
+public:
+    JobSystem();
+    ~JobSystem();
+
+    // Start worker_count worker threads (0 runs everything on the caller)
+    // Return 0 if ok, else -1
+    int startUp(int worker_count);
+
+    // Stop and join worker threads
+    void shutDown();
+
+    // Return count of worker threads
+    int getWorkerCount() const;
+
+    // Return count of jobs run by a thread other than the one queued for
+    long int getStolen() const;
+
+    // Call fn on chunks of at most chunk indices covering [0, count),
+    // across workers and the calling thread. Returns when all are done.
+    void parallelFor(int count, int chunk, const JobRange &fn);
+};
+
+} // end namespace df
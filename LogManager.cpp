@@ -1,71 +1,307 @@
 #include "LogManager.h"
 #include <cstdio>
 #include <cstdarg>
-#include <ctime>
+#include <cstring>
 
 namespace df {
 
-LogManager::LogManager() : m_do_flush(false) {
+// Fill record as writeLog() would, for messages from the writer itself
+static void makeRecord(LogRecord &record, std::int64_t time_ns, LogLevel level,
+                       const char *fmt, ...) {
+    record.time_ns = time_ns;
+    record.fmt = fmt;
+    record.level = (std::uint8_t)level;
+    record.fmt_size = 0;
+    va_list args;
+    va_start(args, fmt);
+    record.arg_size = (std::uint16_t)encodeLogArgs(fmt, args, record.args,
+                                                   LOG_RECORD_ARG_BYTES);
+    va_end(args);
+}
+
+// Writer thread sleeps this long when the queue is empty
+static const std::chrono::milliseconds WRITER_IDLE_SLEEP(1);
+
+LogManager::LogManager()
+    : m_do_flush(false)
+    , m_binary(false)
+    , m_queue(LOG_QUEUE_SIZE_DEFAULT)
+    , m_accepting(false)
+    , m_writer_running(false)
+    , m_full_policy(LOG_DROP)
+    , m_level(DF_LOG_COMPILE_LEVEL < LOG_ERROR ? DF_LOG_COMPILE_LEVEL : LOG_ERROR)
+    , m_queued(0)
+    , m_written(0)
+    , m_dropped(0)
+    , m_reported_dropped(0)
+    , m_base_ns(0)
+{
     setType("LogManager");
 }
 
+LogManager::~LogManager() {
+    shutDown();
+}
+
 LogManager &LogManager::getInstance() {
     static LogManager instance;
     return instance;
 }
 
 int LogManager::startUp() {
-    m_p_f.open(LOGFILE_DEFAULT, std::ofstream::out);
+    if (isStarted()) {
+        return 0; // already started
+    }
+    if (m_binary) {
+        m_p_f.open(LOGFILE_BINARY_DEFAULT, std::ofstream::out | std::ofstream::binary);
+    } else {
+        m_p_f.open(LOGFILE_DEFAULT, std::ofstream::out);
+    }
     if (!m_p_f.is_open()) {
         return -1;
     }
+    m_start_steady = std::chrono::steady_clock::now();
+    m_base_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    if (m_binary) {
+        m_p_f.write(LOG_BINARY_MAGIC, sizeof(LOG_BINARY_MAGIC));
+        m_p_f.write((const char *)&m_base_ns, sizeof(m_base_ns));
+    }
+    m_format_ids.clear();
+    m_formats.clear();
+    m_format_cache.clear();
+    m_queued = 0;
+    m_written = 0;
+    m_dropped = 0;
+    m_reported_dropped = 0;
+    m_writer_running = true;
+    m_writer = std::thread(&LogManager::writerLoop, this);
+    m_accepting = true;
     Manager::startUp();
     return 0;
 }
 
+// Stop accepting, let the writer drain the queue and exit, then write
+// anything queued after its last pass before closing the file.
 void LogManager::shutDown() {
+    m_accepting = false;
+    if (m_writer.joinable()) {
+        m_writer_running = false;
+        m_writer.join();
+    }
+    LogRecord record;
+    while (m_queue.pop(record)) {
+        writeRecord(record);
+        m_written++;
+    }
     if (m_p_f.is_open()) {
+        writeDroppedNote();
         m_p_f.close();
     }
     Manager::shutDown();
 }
 
+int LogManager::setBinary(bool new_binary) {
+    if (isStarted()) {
+        return -1;
+    }
+    m_binary = new_binary;
+    return 0;
+}
+
+bool LogManager::isBinary() const {
+    return m_binary;
+}
+
 void LogManager::setFlush(bool new_do_flush) {
     m_do_flush = new_do_flush;
 }
 
-int LogManager::writeLog(const char *fmt, ...) const {
-    if (!m_p_f.is_open()) {
-        return -1;
+void LogManager::setFullPolicy(LogFullPolicy new_policy) {
+    m_full_policy = new_policy;
+}
+
+LogFullPolicy LogManager::getFullPolicy() const {
+    return m_full_policy;
+}
+
+long int LogManager::getDropped() const {
+    return m_dropped;
+}
+
+void LogManager::drain() {
+    long int target = m_queued;
+    while (m_writer_running && m_written < target) {
+        std::this_thread::sleep_for(WRITER_IDLE_SLEEP);
     }
+    std::lock_guard<std::mutex> lock(m_file_mutex);
+    if (m_p_f.is_open()) m_p_f.flush();
+}
+
+void LogManager::setLevel(LogLevel new_level) {
+    m_level = new_level;
+}
+
+LogLevel LogManager::getLevel() const {
+    return (LogLevel)m_level.load();
+}
 
-    // Get timestamp
-    time_t t = time(nullptr);
-    char time_buf[20];
-    struct tm *tm_info = localtime(&t);
-    strftime(time_buf, sizeof(time_buf), "%H:%M:%S", tm_info);
+int LogManager::writeLog(const char *fmt, ...) {
+    if (!isLogged(LOG_INFO)) {
+        return 0;
+    }
+    va_list args;
+    va_start(args, fmt);
+    int result = queueLog(LOG_INFO, fmt, args, true);
+    va_end(args);
+    return result;
+}
 
-    // Write timestamp
-    const_cast<std::ofstream &>(m_p_f) << "[" << time_buf << "] ";
+int LogManager::writeLog(LogLevel level, const char *fmt, ...) {
+    if (!isLogged(level)) {
+        return 0;
+    }
+    va_list args;
+    va_start(args, fmt);
+    int result = queueLog(level, fmt, args, true);
+    va_end(args);
+    return result;
+}
 
-    // Format and write the message
+int LogManager::writeLiteralLog(LogLevel level, const char *fmt, ...) {
+    if (!isLogged(level)) {
+        return 0;
+    }
     va_list args;
     va_start(args, fmt);
-    char buf[1024];
-    int ret = vsnprintf(buf, sizeof(buf), fmt, args);
+    int result = queueLog(level, fmt, args, false);
     va_end(args);
+    return result;
+}
 
-    if (ret < 0) {
+int LogManager::queueLog(LogLevel level, const char *fmt, va_list args,
+                         bool copy_fmt) {
+    if (!m_accepting.load(std::memory_order_relaxed)) {
         return -1;
     }
 
-    const_cast<std::ofstream &>(m_p_f) << buf << "\n";
+    size_t ticket;
+    LogRecord *p_record = m_queue.reserve(ticket);
+    while (p_record == nullptr) {
+        if (m_full_policy.load(std::memory_order_relaxed) == LOG_DROP) {
+            m_dropped++;
+            return -1;
+        }
+        std::this_thread::yield();
+        p_record = m_queue.reserve(ticket);
+    }
+
+    p_record->time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - m_start_steady).count();
+    p_record->fmt = fmt;
+    p_record->level = (std::uint8_t)level;
+    p_record->fmt_size = 0;
+    if (copy_fmt) {
+        // The caller's buffer may be gone by the time the writer formats
+        size_t len = strnlen(fmt, LOG_FORMAT_COPY_MAX);
+        std::memcpy(p_record->args, fmt, len);
+        p_record->args[len] = '\0';
+        p_record->fmt_size = (std::uint16_t)(len + 1);
+    }
+    p_record->arg_size = (std::uint16_t)encodeLogArgs(
+        logRecordFormat(*p_record), args, p_record->args + p_record->fmt_size,
+        LOG_RECORD_ARG_BYTES - p_record->fmt_size);
+    m_queued++;
+    m_queue.commit(ticket);
+    return 0;
+}
+
+void LogManager::writerLoop() {
+    LogRecord record;
+    for (;;) {
+        bool running = m_writer_running.load(std::memory_order_acquire);
+
+        int written = 0;
+        {
+            std::lock_guard<std::mutex> lock(m_file_mutex);
+            while (m_queue.pop(record)) {
+                writeRecord(record);
+                written++;
+            }
+
+            writeDroppedNote();
+
+            if (written > 0) {
+                if (m_do_flush || !running) m_p_f.flush();
+                m_written += written;
+            }
+        }
+
+        if (!running) break;
+        if (written == 0) {
+            std::this_thread::sleep_for(WRITER_IDLE_SLEEP);
+        }
+    }
+}
+
+void LogManager::writeRecord(const LogRecord &record) {
+    if (!m_binary) {
+        char line[LOG_MESSAGE_MAX];
+        formatLogLine(record, m_base_ns, line, sizeof(line));
+        m_p_f << line << "\n";
+        return;
+    }
+
+    std::uint32_t id = formatId(logRecordFormat(record), record.fmt_size == 0);
+    std::uint8_t tag = LOG_TAG_RECORD;
+    m_p_f.write((const char *)&tag, sizeof(tag));
+    m_p_f.write((const char *)&id, sizeof(id));
+    m_p_f.write((const char *)&record.level, sizeof(record.level));
+    m_p_f.write((const char *)&record.time_ns, sizeof(record.time_ns));
+    m_p_f.write((const char *)&record.arg_size, sizeof(record.arg_size));
+    m_p_f.write((const char *)record.args + record.fmt_size, record.arg_size);
+}
 
-    if (m_do_flush) {
-        const_cast<std::ofstream &>(m_p_f).flush();
+// Formats are keyed by text. The id of each literal is cached by address
+// and checked with one compare, so literals (nearly every format) skip
+// hashing the text; copied formats are always looked up by text.
+std::uint32_t LogManager::formatId(const char *fmt, bool literal) {
+    if (literal) {
+        auto cached = m_format_cache.find(fmt);
+        if (cached != m_format_cache.end() &&
+            std::strcmp(m_formats[cached->second].c_str(), fmt) == 0) {
+            return cached->second;
+        }
+    }
+    std::string text(fmt);
+    auto it = m_format_ids.find(text);
+    if (it == m_format_ids.end()) {
+        std::uint32_t id = (std::uint32_t)m_formats.size();
+        it = m_format_ids.emplace(text, id).first;
+        m_formats.push_back(text);
+        std::uint16_t len16 = (std::uint16_t)(text.size() < 0xffff ? text.size() : 0xffff);
+        std::uint8_t tag = LOG_TAG_FORMAT;
+        m_p_f.write((const char *)&tag, sizeof(tag));
+        m_p_f.write((const char *)&id, sizeof(id));
+        m_p_f.write((const char *)&len16, sizeof(len16));
+        m_p_f.write(fmt, len16);
     }
+    if (literal) m_format_cache[fmt] = it->second;
+    return it->second;
+}
 
-    return ret;
+void LogManager::writeDroppedNote() {
+    long int dropped = m_dropped;
+    if (dropped == m_reported_dropped) {
+        return;
+    }
+    std::int64_t time_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - m_start_steady).count();
+    LogRecord record;
+    makeRecord(record, time_ns, LOG_WARN, "LogManager - %ld records dropped (queue full)",
+               dropped - m_reported_dropped);
+    writeRecord(record);
+    m_reported_dropped = dropped;
 }
 
 } // end namespace df
@@ -1,42 +1,184 @@
 #pragma once
 
+#include <atomic>
+#include <cstdarg>
+#include <chrono>
 #include <fstream>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "LogQueue.h"
 #include "Manager.h"
 
 // Default log file name
 const std::string LOGFILE_DEFAULT = "dragonfly.log";
 
+// Default log file name in binary mode (decode with dflog)
+const std::string LOGFILE_BINARY_DEFAULT = "dragonfly.dflog";
+
+// Records the log queue holds before the full-queue policy applies
+const int LOG_QUEUE_SIZE_DEFAULT = 4096;
+
 #define LM df::LogManager::getInstance()
 
+// Lowest level logging macros compile in: 0 debug, 1 info, 2 warn, 3 error,
+// 4 none. Defaults to debug, or info when NDEBUG is defined.
+#ifndef DF_LOG_COMPILE_LEVEL
+#ifdef NDEBUG
+#define DF_LOG_COMPILE_LEVEL 1
+#else
+#define DF_LOG_COMPILE_LEVEL 0
+#endif
+#endif
+
+// Log at level if the runtime threshold allows. Arguments are not
+// evaluated when the message is filtered out. The format must be a string
+// literal (pasting "" onto anything else fails to compile), so it is kept
+// by pointer instead of copied.
+#define DF_LOG(level, ...) \
+    do { \
+        if (LM.isLogged(level)) LM.writeLiteralLog(level, "" __VA_ARGS__); \
+    } while (0)
+
+// Per-level macros; levels below DF_LOG_COMPILE_LEVEL compile to nothing
+#if DF_LOG_COMPILE_LEVEL <= 0
+#define DF_LOG_DEBUG(...) DF_LOG(df::LOG_DEBUG, __VA_ARGS__)
+#else
+#define DF_LOG_DEBUG(...) ((void)0)
+#endif
+#if DF_LOG_COMPILE_LEVEL <= 1
+#define DF_LOG_INFO(...) DF_LOG(df::LOG_INFO, __VA_ARGS__)
+#else
+#define DF_LOG_INFO(...) ((void)0)
+#endif
+#if DF_LOG_COMPILE_LEVEL <= 2
+#define DF_LOG_WARN(...) DF_LOG(df::LOG_WARN, __VA_ARGS__)
+#else
+#define DF_LOG_WARN(...) ((void)0)
+#endif
+#if DF_LOG_COMPILE_LEVEL <= 3
+#define DF_LOG_ERROR(...) DF_LOG(df::LOG_ERROR, __VA_ARGS__)
+#else
+#define DF_LOG_ERROR(...) ((void)0)
+#endif
+
 namespace df {
 
+// What writeLog() does when the log queue is full
+enum LogFullPolicy {
+    LOG_DROP,   // Discard the record and count it (caller never stalls)
+    LOG_BLOCK,  // Wait for the writer thread to make room
+};
+
 class LogManager : public Manager {
 private:
-    bool m_do_flush;         // True if flush to disk after every write
-    std::ofstream m_p_f;     // Pointer to log file
+    std::atomic<bool> m_do_flush;        // True if flush to disk after writes
+    bool m_binary;                       // True if writing binary log
+    std::ofstream m_p_f;                 // Log file (written by writer thread)
+    LogQueue m_queue;                    // Records waiting to be written
+    std::thread m_writer;                // Background writer thread
+    std::mutex m_file_mutex;             // Held by writer while writing a batch
+    std::atomic<bool> m_accepting;       // True while writeLog() may queue
+    std::atomic<bool> m_writer_running;  // False asks writer to drain and exit
+    std::atomic<LogFullPolicy> m_full_policy; // Policy when queue is full
+    std::atomic<int> m_level;            // Lowest level written
+    std::atomic<long int> m_queued;      // Records queued since startUp()
+    std::atomic<long int> m_written;     // Records written since startUp()
+    std::atomic<long int> m_dropped;     // Records dropped (queue full)
+    long int m_reported_dropped;         // Dropped count last noted in log
+    std::unordered_map<std::string, std::uint32_t> m_format_ids; // Formats in binary log
+    std::vector<std::string> m_formats;  // Their text, by id
+    std::unordered_map<const char *, std::uint32_t> m_format_cache; // Id last
+                                         // seen at each format address
+    std::chrono::steady_clock::time_point m_start_steady;  // Timestamp base
+    std::int64_t m_base_ns;              // Wall time at base (ns since epoch)
 
     LogManager();                               // Private (singleton)
     LogManager(LogManager const &);             // No copy
     void operator=(LogManager const &);         // No assign
 
+    // Writer thread: pop, format and write records until stopped and empty
+    void writerLoop();
+
+    // Write one record to file: formatted as "[HH:MM:SS] LEVEL message"
+    // in text mode, else as a binary entry (preceded by its format string
+    // the first time that format is seen)
+    void writeRecord(const LogRecord &record);
+
+    // Write a record noting records dropped since the last note, if any
+    void writeDroppedNote();
+
+    // Return binary log id of format, writing its definition first if new.
+    // literal if fmt is a string literal (so its address identifies it).
+    std::uint32_t formatId(const char *fmt, bool literal);
+
+    // Queue message at level (already known to pass the threshold)
+    int queueLog(LogLevel level, const char *fmt, va_list args, bool copy_fmt);
+
 public:
+    // Stop writer thread if still running
+    ~LogManager();
+
     // Get the one and only instance of LogManager
     static LogManager &getInstance();
 
-    // Start up LogManager: open log file
+    // Start up LogManager: open log file, start writer thread
     // Return 0 if ok, else -1
     int startUp();
 
-    // Shut down LogManager: close log file
+    // Shut down LogManager: write every queued record, then close log file
     void shutDown();
 
-    // Set flush (true = flush after every write, false = buffer)
+    // Set binary mode: write format ids, timestamps and raw arguments to
+    // LOGFILE_BINARY_DEFAULT instead of text to LOGFILE_DEFAULT.
+    // Return 0 if ok, else -1 (already started).
+    int setBinary(bool new_binary = true);
+
+    // Return true if in binary mode
+    bool isBinary() const;
+
+    // Set flush (true = flush after each batch of writes, false = buffer)
     void setFlush(bool new_do_flush);
 
-    // Write formatted string to log file.
-    // printf-style format string, return 0 if ok, else -1.
-    int writeLog(const char *fmt, ...) const;
+    // Set what writeLog() does when the queue is full (default LOG_DROP)
+    void setFullPolicy(LogFullPolicy new_policy);
+
+    // Get full-queue policy
+    LogFullPolicy getFullPolicy() const;
+
+    // Set lowest level written (default DF_LOG_COMPILE_LEVEL, i.e.
+    // LOG_DEBUG in debug builds and LOG_INFO with NDEBUG)
+    void setLevel(LogLevel new_level);
+
+    // Get lowest level written
+    LogLevel getLevel() const;
+
+    // Return true if messages at level pass the runtime threshold
+    bool isLogged(LogLevel level) const {
+        return level >= m_level.load(std::memory_order_relaxed);
+    }
+
+    // Return count of records dropped because the queue was full
+    long int getDropped() const;
+
+    // Block until every record queued so far is written and flushed
+    void drain();
+
+    // Queue printf-style message for the writer thread. The format and
+    // string arguments are copied, so fmt may be a temporary buffer.
+    // Logged at LOG_INFO.
+    // Return 0 if queued or below the level threshold, else -1 (not
+    // started, or dropped).
+    int writeLog(const char *fmt, ...);
+
+    // As above, logged at level
+    int writeLog(LogLevel level, const char *fmt, ...);
+
+    // As above, but only the format pointer is kept, so fmt must be a
+    // string literal. Use DF_LOG(), which checks that at compile time.
+    int writeLiteralLog(LogLevel level, const char *fmt, ...);
 };
 
 } // end namespace df
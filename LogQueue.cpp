@@ -0,0 +1,72 @@
+#include "LogQueue.h"
+#include <cstdint>
+
+namespace df {
+
+size_t LogQueue::roundUp(size_t capacity) {
+    size_t size = 2;
+    while (size < capacity) size <<= 1;
+    return size;
+}
+
+LogQueue::LogQueue(size_t capacity)
+    : m_slots(roundUp(capacity))
+    , m_mask(m_slots.size() - 1)
+    , m_enqueue_pos(0)
+    , m_dequeue_pos(0)
+{
+    for (size_t i = 0; i < m_slots.size(); i++) {
+        m_slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+// A slot is free for position pos when its sequence equals pos; the
+// producer that wins the CAS on m_enqueue_pos owns it until commit().
+LogRecord *LogQueue::reserve(size_t &ticket) {
+    size_t pos = m_enqueue_pos.load(std::memory_order_relaxed);
+    for (;;) {
+        Slot &slot = m_slots[pos & m_mask];
+        size_t seq = slot.sequence.load(std::memory_order_acquire);
+        std::intptr_t diff = (std::intptr_t)seq - (std::intptr_t)pos;
+        if (diff == 0) {
+            if (m_enqueue_pos.compare_exchange_weak(pos, pos + 1,
+                                                    std::memory_order_relaxed)) {
+                ticket = pos;
+                return &slot.record;
+            }
+        } else if (diff < 0) {
+            return nullptr; // full
+        } else {
+            pos = m_enqueue_pos.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+void LogQueue::commit(size_t ticket) {
+    m_slots[ticket & m_mask].sequence.store(ticket + 1, std::memory_order_release);
+}
+
+bool LogQueue::pop(LogRecord &out) {
+    size_t pos = m_dequeue_pos.load(std::memory_order_relaxed);
+    Slot &slot = m_slots[pos & m_mask];
+    size_t seq = slot.sequence.load(std::memory_order_acquire);
+    if (seq != pos + 1) {
+        return false; // empty (or next record not committed yet)
+    }
+    out = slot.record;
+    m_dequeue_pos.store(pos + 1, std::memory_order_relaxed);
+    slot.sequence.store(pos + m_mask + 1, std::memory_order_release);
+    return true;
+}
+
+bool LogQueue::isEmpty() const {
+    size_t pos = m_dequeue_pos.load(std::memory_order_relaxed);
+    const Slot &slot = m_slots[pos & m_mask];
+    return slot.sequence.load(std::memory_order_acquire) != pos + 1;
+}
+
+size_t LogQueue::getCapacity() const {
+    return m_slots.size();
+}
+
+} // end namespace df
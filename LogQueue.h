@@ -0,0 +1,53 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+#include "LogRecord.h"
+
+namespace df {
+
+// Bounded lock-free multi-producer queue of log records (Vyukov ring:
+// each slot carries a sequence number telling producers and the consumer
+// whose turn it is). Any thread may push; one writer thread pops.
+class LogQueue {
+private:
+    struct Slot {
+        std::atomic<size_t> sequence; // Turn counter for this slot
+        LogRecord record;             // Record stored in slot
+    };
+
+    std::vector<Slot> m_slots;          // Ring of slots (power-of-2 size)
+    size_t m_mask;                      // Slot count - 1
+    alignas(64) std::atomic<size_t> m_enqueue_pos; // Next slot to fill
+    alignas(64) std::atomic<size_t> m_dequeue_pos; // Next slot to drain
+
+    LogQueue(LogQueue const &);          // No copy
+    void operator=(LogQueue const &);    // No assign
+
+    // Return smallest power of 2 >= capacity (at least 2)
+    static size_t roundUp(size_t capacity);
+
+public:
+    // Create queue with capacity rounded up to a power of 2
+    explicit LogQueue(size_t capacity);
+
+    // Reserve a slot and return the record to fill, or nullptr if the
+    // queue is full. Must be followed by commit(ticket).
+    LogRecord *reserve(size_t &ticket);
+
+    // Publish the record reserved with ticket to the consumer
+    void commit(size_t ticket);
+
+    // Copy oldest record into out (single consumer only)
+    // Return true if a record was popped, false if queue is empty
+    bool pop(LogRecord &out);
+
+    // Return true if no records are waiting
+    bool isEmpty() const;
+
+    // Return slot count
+    size_t getCapacity() const;
+};
+
+} // end namespace df
@@ -0,0 +1,410 @@
+#include "LogRecord.h"
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+
+namespace df {
+
+namespace {
+
+// Level names as written to the log, padded to one width
+const char *LEVEL_NAMES[] = {"DEBUG", "INFO ", "WARN ", "ERROR"};
+
+// Length modifiers
+enum Length {LEN_NONE, LEN_HH, LEN_H, LEN_L, LEN_LL, LEN_J, LEN_Z, LEN_T, LEN_BIG_L};
+
+// One printf conversion specification, e.g. "%-8.*ld". Text fields point
+// into the format string.
+struct Conversion {
+    const char *flags;     // Any of "-+ #0"
+    int flags_len;
+    const char *width;     // Digits or "*" (length 0 if none)
+    int width_len;
+    const char *precision; // ".digits", ".*" or "." (length 0 if none)
+    int precision_len;
+    Length length;         // Length modifier
+    char conv;             // Conversion character
+
+    bool starWidth() const     { return width_len == 1 && width[0] == '*'; }
+    bool starPrecision() const { return precision_len == 2 && precision[1] == '*'; }
+};
+
+// Parse conversion at p (just past the '%'). Return pointer past the
+// conversion character, or nullptr if it is not one we understand (the
+// rest of the format is then treated as literal text).
+const char *parseConversion(const char *p, Conversion &c) {
+    c.flags = p;
+    while (*p && std::strchr("-+ #0", *p)) p++;
+    c.flags_len = (int)(p - c.flags);
+    c.width = p;
+    if (*p == '*') {
+        p++;
+    } else {
+        while (*p >= '0' && *p <= '9') p++;
+    }
+    c.width_len = (int)(p - c.width);
+    c.precision = p;
+    if (*p == '.') {
+        p++;
+        if (*p == '*') {
+            p++;
+        } else {
+            while (*p >= '0' && *p <= '9') p++;
+        }
+    }
+    c.precision_len = (int)(p - c.precision);
+    c.length = LEN_NONE;
+    switch (*p) {
+    case 'h': c.length = (p[1] == 'h') ? LEN_HH : LEN_H; break;
+    case 'l': c.length = (p[1] == 'l') ? LEN_LL : LEN_L; break;
+    case 'j': c.length = LEN_J; break;
+    case 'z': c.length = LEN_Z; break;
+    case 't': c.length = LEN_T; break;
+    case 'L': c.length = LEN_BIG_L; break;
+    default: break;
+    }
+    if (c.length == LEN_HH || c.length == LEN_LL) p += 2;
+    else if (c.length != LEN_NONE) p++;
+    if (*p == '\0' || !std::strchr("diouxXcsfFeEgGaApn%", *p)) {
+        return nullptr;
+    }
+    c.conv = *p++;
+    return p;
+}
+
+bool isSignedConv(char conv)   { return conv == 'd' || conv == 'i'; }
+bool isUnsignedConv(char conv) { return std::strchr("ouxX", conv) != nullptr; }
+bool isDoubleConv(char conv)   { return std::strchr("fFeEgGaA", conv) != nullptr; }
+
+// Conversion spec rebuilt for snprintf with '*' values filled in
+struct Spec {
+    char text[64];
+    int len;
+
+    void add(const char *s, int n) {
+        if (n > (int)sizeof(text) - 1 - len) n = (int)sizeof(text) - 1 - len;
+        std::memcpy(text + len, s, n);
+        len += n;
+        text[len] = '\0';
+    }
+    void add(const char *s)       { add(s, (int)std::strlen(s)); }
+    void addInt(std::int64_t v) {
+        char num[24];
+        add(num, std::snprintf(num, sizeof(num), "%lld", (long long)v));
+    }
+};
+
+// Bounded writer into an encode buffer
+struct Encoder {
+    unsigned char *buf;
+    int capacity;
+    int size;
+
+    bool put(const void *data, int n) {
+        if (size + n > capacity) return false;
+        std::memcpy(buf + size, data, n);
+        size += n;
+        return true;
+    }
+    bool putInt(std::int64_t v)   { return put(&v, sizeof(v)); }
+    bool putDouble(double v)      { return put(&v, sizeof(v)); }
+
+    // Store length then characters, truncating to what fits
+    bool putString(const char *s, int max_len) {
+        int room = capacity - size - (int)sizeof(std::uint16_t);
+        if (room < 0) return false;
+        if (max_len > room) max_len = room;
+        if (max_len > 0xffff) max_len = 0xffff;
+        std::uint16_t len = (std::uint16_t)strnlen(s, (size_t)max_len);
+        put(&len, sizeof(len));
+        return put(s, len);
+    }
+};
+
+// Bounded reader over an encoded buffer
+struct Decoder {
+    const unsigned char *buf;
+    int size;
+    int pos;
+
+    bool get(void *data, int n) {
+        if (pos + n > size) return false;
+        std::memcpy(data, buf + pos, n);
+        pos += n;
+        return true;
+    }
+    bool getInt(std::int64_t &v) { return get(&v, sizeof(v)); }
+    bool getDouble(double &v)    { return get(&v, sizeof(v)); }
+};
+
+// Bounded writer into the formatted message
+struct Output {
+    char *out;
+    int out_size;
+    int len;
+
+    void append(const char *s, int n) {
+        int room = out_size - 1 - len;
+        if (n > room) n = room;
+        if (n <= 0) return;
+        std::memcpy(out + len, s, n);
+        len += n;
+        out[len] = '\0';
+    }
+
+    // snprintf one conversion; arg types are fixed by the rebuilt spec
+    template <class T>
+    void format(const Spec &spec, T value) {
+        char piece[LOG_MESSAGE_MAX];
+        int n = std::snprintf(piece, sizeof(piece), spec.text, value);
+        if (n > (int)sizeof(piece) - 1) n = (int)sizeof(piece) - 1;
+        if (n > 0) append(piece, n);
+    }
+};
+
+} // end anonymous namespace
+
+int encodeLogArgs(const char *fmt, va_list args,
+                  unsigned char *buf, int capacity) {
+    Encoder e = {buf, capacity, 0};
+    const char *p = fmt;
+    while ((p = std::strchr(p, '%')) != nullptr) {
+        Conversion c;
+        const char *next = parseConversion(p + 1, c);
+        if (next == nullptr) break;
+        p = next;
+
+        long long precision = -1;
+        if (c.starWidth()) {
+            e.putInt(va_arg(args, int));
+        }
+        if (c.starPrecision()) {
+            int star = va_arg(args, int);
+            e.putInt(star);
+            precision = star;
+        } else if (c.precision_len > 0) {
+            precision = 0;
+            for (int i = 1; i < c.precision_len; i++) {
+                precision = precision * 10 + (c.precision[i] - '0');
+            }
+        }
+
+        if (isSignedConv(c.conv)) {
+            std::int64_t v;
+            switch (c.length) {
+            case LEN_L:  v = va_arg(args, long); break;
+            case LEN_LL: v = va_arg(args, long long); break;
+            case LEN_J:  v = va_arg(args, intmax_t); break;
+            case LEN_Z:
+            case LEN_T:  v = va_arg(args, ptrdiff_t); break;
+            case LEN_HH: v = (signed char)va_arg(args, int); break;
+            case LEN_H:  v = (short)va_arg(args, int); break;
+            default:     v = va_arg(args, int); break;
+            }
+            e.putInt(v);
+        } else if (isUnsignedConv(c.conv)) {
+            std::uint64_t v;
+            switch (c.length) {
+            case LEN_L:  v = va_arg(args, unsigned long); break;
+            case LEN_LL: v = va_arg(args, unsigned long long); break;
+            case LEN_J:  v = va_arg(args, uintmax_t); break;
+            case LEN_Z:
+            case LEN_T:  v = va_arg(args, size_t); break;
+            case LEN_HH: v = (unsigned char)va_arg(args, unsigned int); break;
+            case LEN_H:  v = (unsigned short)va_arg(args, unsigned int); break;
+            default:     v = va_arg(args, unsigned int); break;
+            }
+            e.putInt((std::int64_t)v);
+        } else if (isDoubleConv(c.conv)) {
+            double v;
+            if (c.length == LEN_BIG_L) v = (double)va_arg(args, long double);
+            else                       v = va_arg(args, double);
+            e.putDouble(v);
+        } else if (c.conv == 'c') {
+            e.putInt(va_arg(args, int));
+        } else if (c.conv == 's') {
+            if (c.length == LEN_L) {
+                va_arg(args, wchar_t *); // wide strings not supported
+                e.putString("(wide string)", LOG_RECORD_ARG_BYTES);
+            } else {
+                const char *s = va_arg(args, const char *);
+                if (s == nullptr) s = "(null)";
+                int max_len = (precision >= 0 && precision < LOG_RECORD_ARG_BYTES)
+                              ? (int)precision : LOG_RECORD_ARG_BYTES;
+                e.putString(s, max_len);
+            }
+        } else if (c.conv == 'p') {
+            e.putInt((std::int64_t)(std::uintptr_t)va_arg(args, void *));
+        } else if (c.conv == 'n') {
+            va_arg(args, void *); // nothing is written back
+        }
+        // '%%' consumes no argument
+    }
+    return e.size;
+}
+
+int formatLogArgs(const char *fmt, const unsigned char *buf, int size,
+                  char *out, int out_size) {
+    if (out_size <= 0) return 0;
+    out[0] = '\0';
+    Output o = {out, out_size, 0};
+    Decoder d = {buf, size, 0};
+    const char *p = fmt;
+    while (*p) {
+        const char *pct = std::strchr(p, '%');
+        if (pct == nullptr) {
+            o.append(p, (int)std::strlen(p));
+            break;
+        }
+        o.append(p, (int)(pct - p));
+
+        Conversion c;
+        const char *next = parseConversion(pct + 1, c);
+        if (next == nullptr) {
+            o.append(pct, (int)std::strlen(pct)); // not understood: literal
+            break;
+        }
+        p = next;
+        if (c.conv == '%') {
+            o.append("%", 1);
+            continue;
+        }
+
+        // Rebuild spec with stored '*' values
+        Spec spec = {"%", 1};
+        spec.add(c.flags, c.flags_len);
+        std::int64_t star;
+        if (c.starWidth()) {
+            if (!d.getInt(star)) break;
+            spec.addInt(star);
+        } else {
+            spec.add(c.width, c.width_len);
+        }
+        if (c.starPrecision()) {
+            if (!d.getInt(star)) break;
+            spec.add(".");
+            spec.addInt(star);
+        } else {
+            spec.add(c.precision, c.precision_len);
+        }
+
+        bool ok = true;
+        if (isSignedConv(c.conv) || isUnsignedConv(c.conv)) {
+            std::int64_t v;
+            ok = d.getInt(v);
+            spec.add("ll");
+            spec.add(&c.conv, 1);
+            if (ok && isSignedConv(c.conv)) o.format(spec, (long long)v);
+            else if (ok)                    o.format(spec, (unsigned long long)v);
+        } else if (isDoubleConv(c.conv)) {
+            double v;
+            ok = d.getDouble(v);
+            spec.add(&c.conv, 1);
+            if (ok) o.format(spec, v);
+        } else if (c.conv == 'c') {
+            std::int64_t v;
+            ok = d.getInt(v);
+            spec.add("c");
+            if (ok) o.format(spec, (int)v);
+        } else if (c.conv == 's') {
+            std::uint16_t len;
+            char s[LOG_RECORD_ARG_BYTES + 1];
+            ok = d.get(&len, sizeof(len)) && len <= LOG_RECORD_ARG_BYTES
+                 && d.get(s, len);
+            spec.add("s");
+            if (ok) {
+                s[len] = '\0';
+                o.format(spec, (const char *)s);
+            }
+        } else if (c.conv == 'p') {
+            std::int64_t v;
+            ok = d.getInt(v);
+            spec.add("p");
+            if (ok) o.format(spec, (void *)(std::uintptr_t)v);
+        }
+        // 'n' writes nothing
+
+        if (!ok) {
+            o.append("<truncated>", 11);
+            break;
+        }
+    }
+    return o.len;
+}
+
+const char *logRecordFormat(const LogRecord &record) {
+    return record.fmt_size > 0 ? (const char *)record.args : record.fmt;
+}
+
+int formatLogLine(const LogRecord &record, std::int64_t base_ns,
+                  char *out, int out_size) {
+    // localtime_r() is slow; consecutive records mostly share a second
+    thread_local time_t last_t = -1;
+    thread_local char time_buf[20];
+    std::int64_t wall_ns = base_ns + record.time_ns;
+    time_t t = (time_t)(wall_ns / 1000000000);
+    if (t != last_t) {
+        struct tm tm_info;
+        localtime_r(&t, &tm_info);
+        strftime(time_buf, sizeof(time_buf), "%H:%M:%S", &tm_info);
+        last_t = t;
+    }
+
+    const char *level = record.level <= LOG_ERROR ? LEVEL_NAMES[record.level] : "?    ";
+    int len = std::snprintf(out, out_size, "[%s] %s ", time_buf, level);
+    if (len < 0 || len >= out_size) return out_size > 0 ? out_size - 1 : 0;
+    return len + formatLogArgs(logRecordFormat(record),
+                               record.args + record.fmt_size, record.arg_size,
+                               out + len, out_size - len);
+}
+
+int decodeLogBinary(std::istream &in, std::ostream &out) {
+    char magic[sizeof(LOG_BINARY_MAGIC)];
+    std::int64_t base_ns;
+    if (!in.read(magic, sizeof(magic))
+        || std::memcmp(magic, LOG_BINARY_MAGIC, sizeof(magic)) != 0
+        || !in.read((char *)&base_ns, sizeof(base_ns))) {
+        return -1;
+    }
+
+    std::unordered_map<std::uint32_t, std::string> formats;
+    LogRecord record;
+    record.fmt_size = 0;
+    char line[LOG_MESSAGE_MAX];
+    std::uint8_t tag;
+    while (in.read((char *)&tag, sizeof(tag))) {
+        std::uint32_t id;
+        if (!in.read((char *)&id, sizeof(id))) return -1;
+
+        if (tag == LOG_TAG_FORMAT) {
+            std::uint16_t len;
+            if (!in.read((char *)&len, sizeof(len))) return -1;
+            std::string fmt(len, '\0');
+            if (!in.read(&fmt[0], len)) return -1;
+            formats[id] = fmt;
+        } else if (tag == LOG_TAG_RECORD) {
+            if (!in.read((char *)&record.level, sizeof(record.level))
+                || !in.read((char *)&record.time_ns, sizeof(record.time_ns))
+                || !in.read((char *)&record.arg_size, sizeof(record.arg_size))
+                || record.arg_size > LOG_RECORD_ARG_BYTES
+                || !in.read((char *)record.args, record.arg_size)) {
+                return -1;
+            }
+            auto it = formats.find(id);
+            if (it == formats.end()) return -1;
+            record.fmt = it->second.c_str();
+            formatLogLine(record, base_ns, line, sizeof(line));
+            out << line << '\n';
+        } else {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+} // end namespace df
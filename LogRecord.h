@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstdarg>
+#include <cstdint>
+#include <iosfwd>
+
+// Bytes of encoded arguments one log record can hold
+const int LOG_RECORD_ARG_BYTES = 224;
+
+// Longest formatted log message (longer messages are truncated)
+const int LOG_MESSAGE_MAX = 1024;
+
+// Longest format string copied into a log record (longer ones are truncated)
+const int LOG_FORMAT_COPY_MAX = LOG_RECORD_ARG_BYTES / 2 - 1;
+
+// Binary log file: header is the magic followed by the wall-clock time of
+// timestamp zero (int64 nanoseconds since the epoch). Then a sequence of
+// entries, each starting with a LogBinaryTag byte:
+//   LOG_TAG_FORMAT: uint32 id, uint16 length, format string characters
+//   LOG_TAG_RECORD: uint32 format id, uint8 level, int64 time_ns,
+//                   uint16 arg size, encoded arguments
+// A format is defined once, before the first record using it. Values are
+// in host byte order; decode on a machine of the same endianness.
+const char LOG_BINARY_MAGIC[8] = {'D', 'F', 'L', 'O', 'G', '0', '1', '\n'};
+
+namespace df {
+
+// Message severity, lowest first
+enum LogLevel {
+    LOG_DEBUG,  // Per-object and per-frame detail
+    LOG_INFO,   // Startup, shutdown and other milestones
+    LOG_WARN,   // Something unexpected the engine recovered from
+    LOG_ERROR,  // Something failed
+};
+
+// Entry types in a binary log file
+enum LogBinaryTag : std::uint8_t {
+    LOG_TAG_FORMAT = 1,  // Format string definition
+    LOG_TAG_RECORD = 2,  // Log record
+};
+
+// Log message captured at the call site and formatted later: timestamp,
+// format string and the raw arguments. A string literal format is kept as
+// a pointer; any other format is copied (null-terminated) to the start of
+// args. Arguments follow, encoded in the order the format consumes them:
+// integers, doubles and pointers as 8 bytes each, strings as a 2-byte
+// length plus the (copied) characters.
+struct LogRecord {
+    std::int64_t time_ns;                     // Monotonic timestamp (nanoseconds)
+    const char *fmt;                          // Literal format, if not copied
+    std::uint8_t level;                       // Severity (df::LogLevel)
+    std::uint16_t fmt_size;                   // Bytes of copied format in args
+    std::uint16_t arg_size;                   // Bytes of arguments after it
+    unsigned char args[LOG_RECORD_ARG_BYTES]; // Copied format, then arguments
+};
+
+// Return format string of record (its copy, if it has one)
+const char *logRecordFormat(const LogRecord &record);
+
+// Encode the arguments fmt consumes from args into buf.
+// Strings are truncated if buf fills up.
+// Return number of bytes used.
+int encodeLogArgs(const char *fmt, va_list args,
+                  unsigned char *buf, int capacity);
+
+// Format fmt with arguments previously encoded by encodeLogArgs() into
+// out (always null-terminated).
+// Return length of formatted message.
+int formatLogArgs(const char *fmt, const unsigned char *buf, int size,
+                  char *out, int out_size);
+
+// Format record as a log line "[HH:MM:SS] LEVEL message" (no newline)
+// into out. base_ns is the wall-clock time (nanoseconds since the epoch)
+// of timestamp zero.
+// Return length of line.
+int formatLogLine(const LogRecord &record, std::int64_t base_ns,
+                  char *out, int out_size);
+
+// Decode binary log from in, writing one text line per record to out.
+// Return 0 if ok, else -1 (bad header or truncated/corrupt entry; lines
+// decoded before the problem are still written).
+int decodeLogBinary(std::istream &in, std::ostream &out);
+
+} // end namespace df
@@ -1,6 +1,7 @@
 #include "Manager.h"
-#include "WorldManager.h"
+#include "Event.h"
 #include "ObjectList.h"
+#include "ObjectListView.h"
 #include "Object.h"
 
 namespace df {
@@ -26,17 +27,52 @@ void Manager::shutDown() {
     m_is_started = false;
 }
 
+ObjectList *Manager::getInterestList(int event_id) {
+    if (event_id < 0 || event_id >= (int)m_interests.size()) return nullptr;
+    return &m_interests[event_id];
+}
+
 bool Manager::isStarted() const {
     return m_is_started;
 }
 
-// Send event to all Objects in the game world.
+int Manager::registerInterest(Object *p_o, int event_id) {
+    if (p_o == nullptr || event_id < 0) return -1;
+    if (event_id >= (int)m_interests.size()) {
+        m_interests.resize(event_id + 1);
+    }
+    return m_interests[event_id].insert(p_o);
+}
+
+int Manager::registerInterest(Object *p_o, std::string event_type) {
+    return registerInterest(p_o, Event::registerType(event_type));
+}
+
+// Lists are never erased, so a view over one stays valid even if the
+// last interested Object unregisters during dispatch.
+int Manager::unregisterInterest(Object *p_o, int event_id) {
+    if (event_id < 0 || event_id >= (int)m_interests.size()) return -1;
+    return m_interests[event_id].remove(p_o);
+}
+
+int Manager::unregisterInterest(Object *p_o, std::string event_type) {
+    return unregisterInterest(p_o, Event::registerType(event_type));
+}
+
+void Manager::removeMarkedInterests(int event_id) {
+    if (event_id < 0 || event_id >= (int)m_interests.size()) return;
+    m_interests[event_id].removeMarked();
+}
+
+// Send event to Objects interested in its type.
 // Return count of objects that handled the event.
-int Manager::onEvent(const Event *p_event) const {
+int Manager::onEvent(const Event *p_event) {
+    int event_id = p_event->getTypeId();
+    if (event_id < 0 || event_id >= (int)m_interests.size()) return 0;
+
     int count = 0;
-    ObjectList all = WM.getAllObjects();
-    for (int i = 0; i < all.getCount(); i++) {
-        count += all[i]->eventHandler(p_event);
+    for (Object *p_o : ObjectListView(m_interests[event_id])) {
+        count += p_o->eventHandler(p_event);
     }
     return count;
 }
@@ -1,9 +1,11 @@
 #pragma once
 
+#include <deque>
 #include <string>
+#include "ObjectList.h"
 
-// Forward declare Event to avoid circular dependency
-namespace df { class Event; }
+// Forward declare Event and Object to avoid circular dependency
+namespace df { class Event; class Object; }
 
 namespace df {
 
@@ -12,10 +14,33 @@ private:
     std::string m_type;    // Manager type identifier
     bool m_is_started;     // true when started successfully
 
+    // Objects interested in each event type, indexed by event type id.
+    // A deque keeps each list in place as new types are added.
+    std::deque<ObjectList> m_interests;
+
+    // Only Object::registerInterest and unregisterInterest register
+    // interests, so each Object records the event types it must
+    // unregister from when deleted
+    friend class Object;
+
+    // Register Object's interest in event type with this Manager
+    // Return 0 if ok, else -1 (already registered)
+    int registerInterest(Object *p_o, int event_id);
+    int registerInterest(Object *p_o, std::string event_type);
+
+    // Unregister Object's interest in event type with this Manager
+    // Return 0 if ok, else -1
+    int unregisterInterest(Object *p_o, int event_id);
+    int unregisterInterest(Object *p_o, std::string event_type);
+
 protected:
     // Set type identifier of Manager
     void setType(std::string type);
 
+    // Return list of Objects interested in event type, or nullptr if none
+    // ever registered
+    ObjectList *getInterestList(int event_id);
+
 public:
     Manager();
     virtual ~Manager();
@@ -33,9 +58,13 @@ public:
     // Return true when startUp() was executed ok, else false
     bool isStarted() const;
 
-    // Send event to all Objects registered with WorldManager.
+    // Drop every Object marked for delete from the interest list for
+    // event type in one pass (used when WorldManager deletes a batch)
+    void removeMarkedInterests(int event_id);
+
+    // Send event to all Objects interested in its type.
     // Return number of objects that handled the event.
-    int onEvent(const Event *p_event) const;
+    int onEvent(const Event *p_event);
 };
 
 } // end namespace df
@@ -0,0 +1,264 @@
+#include "MotionStore.h"
+#include "Object.h"
+#include "ObjectList.h"
+#include <utility>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace df {
+
+MotionStore::MotionStore() : m_awake_count(0) {
+    m_x.reserve(OBJECT_LIST_RESERVE_DEFAULT);
+    m_y.reserve(OBJECT_LIST_RESERVE_DEFAULT);
+    m_vx.reserve(OBJECT_LIST_RESERVE_DEFAULT);
+    m_vy.reserve(OBJECT_LIST_RESERVE_DEFAULT);
+    m_px.reserve(OBJECT_LIST_RESERVE_DEFAULT);
+    m_py.reserve(OBJECT_LIST_RESERVE_DEFAULT);
+    m_prev_step.reserve(OBJECT_LIST_RESERVE_DEFAULT);
+    m_solid.reserve(OBJECT_LIST_RESERVE_DEFAULT);
+    m_moved.reserve(OBJECT_LIST_RESERVE_DEFAULT);
+    m_owner.reserve(OBJECT_LIST_RESERVE_DEFAULT);
+}
+
+int MotionStore::add(Object *p_o) {
+    m_x.push_back(0);
+    m_y.push_back(0);
+    m_vx.push_back(0);
+    m_vy.push_back(0);
+    m_px.push_back(0);
+    m_py.push_back(0);
+    m_prev_step.push_back(-1);
+    m_solid.push_back(0);
+    m_moved.push_back(0);
+    m_owner.push_back(p_o);
+    int index = (int)m_owner.size() - 1;
+    if (index != m_awake_count) {
+        swapSlots(index, m_awake_count);
+    }
+    return m_awake_count++;
+}
+
+// An awake slot first trades places with the last awake slot, so the
+// awake slots stay together.
+void MotionStore::remove(int index) {
+    int last = (int)m_owner.size() - 1;
+    if (index < 0 || index > last) return;
+    if (index < m_awake_count) {
+        m_awake_count--;
+        swapSlots(index, m_awake_count);
+        index = m_awake_count;
+    }
+    if (index != last) {
+        m_x[index] = m_x[last];
+        m_y[index] = m_y[last];
+        m_vx[index] = m_vx[last];
+        m_vy[index] = m_vy[last];
+        m_px[index] = m_px[last];
+        m_py[index] = m_py[last];
+        m_prev_step[index] = m_prev_step[last];
+        m_solid[index] = m_solid[last];
+        m_moved[index] = m_moved[last];
+        m_owner[index] = m_owner[last];
+        m_owner[index]->m_motion_index = index;
+    }
+    m_x.pop_back();
+    m_y.pop_back();
+    m_vx.pop_back();
+    m_vy.pop_back();
+    m_px.pop_back();
+    m_py.pop_back();
+    m_prev_step.pop_back();
+    m_solid.pop_back();
+    m_moved.pop_back();
+    m_owner.pop_back();
+}
+
+int MotionStore::getCount() const {
+    return (int)m_owner.size();
+}
+
+void MotionStore::swapSlots(int a, int b) {
+    if (a == b) return;
+    std::swap(m_x[a], m_x[b]);
+    std::swap(m_y[a], m_y[b]);
+    std::swap(m_vx[a], m_vx[b]);
+    std::swap(m_vy[a], m_vy[b]);
+    std::swap(m_px[a], m_px[b]);
+    std::swap(m_py[a], m_py[b]);
+    std::swap(m_prev_step[a], m_prev_step[b]);
+    std::swap(m_solid[a], m_solid[b]);
+    std::swap(m_moved[a], m_moved[b]);
+    std::swap(m_owner[a], m_owner[b]);
+    m_owner[a]->m_motion_index = a;
+    m_owner[b]->m_motion_index = b;
+}
+
+// Waking swaps the slot with the first asleep one and grows the awake
+// slots over it; sleeping swaps it with the last awake one and shrinks
+// them. A slot going to sleep is no longer marked moved, so takeMoved()
+// only checks awake slots.
+void MotionStore::setAwake(int index, bool awake) {
+    if (index < 0 || index >= (int)m_owner.size()) return;
+    if (awake && index >= m_awake_count) {
+        swapSlots(index, m_awake_count);
+        m_awake_count++;
+    } else if (!awake && index < m_awake_count) {
+        m_awake_count--;
+        swapSlots(index, m_awake_count);
+        m_moved[m_awake_count] = 0;
+    }
+}
+
+int MotionStore::getAwakeCount() const {
+    return m_awake_count;
+}
+
+void MotionStore::collectSolidMovers(std::vector<Object *> &out) const {
+    for (int i = 0; i < m_awake_count; i++) {
+        if (m_solid[i] && (m_vx[i] != 0.0f || m_vy[i] != 0.0f)) {
+            out.push_back(m_owner[i]);
+        }
+    }
+}
+
+void MotionStore::takeMoved(std::vector<Object *> &out) {
+    for (int i = 0; i < m_awake_count; i++) {
+        if (m_moved[i]) {
+            out.push_back(m_owner[i]);
+            m_moved[i] = 0;
+        }
+    }
+}
+
+// Per lane: moving = velocity non-zero and not solid. Moving lanes save
+// their previous position (if not yet saved for step), advance by velocity,
+// are marked moved and are tested against the bounds; other lanes are left
+// as they are.
+void MotionStore::integrate(int step, const Box &bounds, ObjectList &out) {
+    float left = bounds.getCorner().getX();
+    float top = bounds.getCorner().getY();
+    float right = left + bounds.getHorizontal();
+    float bottom = top + bounds.getVertical();
+    int n = m_awake_count;
+    float *x = m_x.data(), *y = m_y.data();
+    const float *vx = m_vx.data(), *vy = m_vy.data();
+    float *px = m_px.data(), *py = m_py.data();
+    std::int32_t *prev_step = m_prev_step.data();
+    const std::int32_t *solid = m_solid.data();
+    std::int32_t *moved = m_moved.data();
+    bool save = step >= 0;
+    int i = 0;
+
+#if defined(__AVX2__)
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 l = _mm256_set1_ps(left);
+    const __m256 t = _mm256_set1_ps(top);
+    const __m256 r = _mm256_set1_ps(right);
+    const __m256 b = _mm256_set1_ps(bottom);
+    const __m256i step8 = _mm256_set1_epi32(step);
+    for (; i + 8 <= n; i += 8) {
+        __m256 lvx = _mm256_loadu_ps(vx + i);
+        __m256 lvy = _mm256_loadu_ps(vy + i);
+        __m256 moving = _mm256_or_ps(_mm256_cmp_ps(lvx, zero, _CMP_NEQ_UQ),
+                                     _mm256_cmp_ps(lvy, zero, _CMP_NEQ_UQ));
+        __m256i lsolid = _mm256_loadu_si256((const __m256i *)(solid + i));
+        moving = _mm256_andnot_ps(_mm256_castsi256_ps(lsolid), moving);
+        if (_mm256_movemask_ps(moving) == 0) continue;
+
+        __m256 lx = _mm256_loadu_ps(x + i);
+        __m256 ly = _mm256_loadu_ps(y + i);
+        if (save) {
+            __m256i lstep = _mm256_loadu_si256((const __m256i *)(prev_step + i));
+            __m256 saved = _mm256_castsi256_ps(_mm256_cmpeq_epi32(lstep, step8));
+            __m256 first = _mm256_andnot_ps(saved, moving);
+            _mm256_storeu_ps(px + i, _mm256_blendv_ps(_mm256_loadu_ps(px + i), lx, first));
+            _mm256_storeu_ps(py + i, _mm256_blendv_ps(_mm256_loadu_ps(py + i), ly, first));
+            _mm256_storeu_si256((__m256i *)(prev_step + i), _mm256_castps_si256(
+                _mm256_blendv_ps(_mm256_castsi256_ps(lstep), _mm256_castsi256_ps(step8), first)));
+        }
+        lx = _mm256_blendv_ps(lx, _mm256_add_ps(lx, lvx), moving);
+        ly = _mm256_blendv_ps(ly, _mm256_add_ps(ly, lvy), moving);
+        _mm256_storeu_ps(x + i, lx);
+        _mm256_storeu_ps(y + i, ly);
+        __m256i lmoved = _mm256_loadu_si256((const __m256i *)(moved + i));
+        _mm256_storeu_si256((__m256i *)(moved + i),
+                            _mm256_or_si256(lmoved, _mm256_castps_si256(moving)));
+
+        __m256 outside = _mm256_or_ps(
+            _mm256_or_ps(_mm256_cmp_ps(lx, l, _CMP_LT_OQ), _mm256_cmp_ps(lx, r, _CMP_GE_OQ)),
+            _mm256_or_ps(_mm256_cmp_ps(ly, t, _CMP_LT_OQ), _mm256_cmp_ps(ly, b, _CMP_GE_OQ)));
+        int out_bits = _mm256_movemask_ps(_mm256_and_ps(outside, moving));
+        for (int lane = 0; out_bits != 0; lane++, out_bits >>= 1) {
+            if (out_bits & 1) out.insert(m_owner[i + lane]);
+        }
+    }
+#elif defined(__SSE2__)
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 l = _mm_set1_ps(left);
+    const __m128 t = _mm_set1_ps(top);
+    const __m128 r = _mm_set1_ps(right);
+    const __m128 b = _mm_set1_ps(bottom);
+    const __m128i step4 = _mm_set1_epi32(step);
+    for (; i + 4 <= n; i += 4) {
+        __m128 lvx = _mm_loadu_ps(vx + i);
+        __m128 lvy = _mm_loadu_ps(vy + i);
+        __m128 moving = _mm_or_ps(_mm_cmpneq_ps(lvx, zero), _mm_cmpneq_ps(lvy, zero));
+        __m128i lsolid = _mm_loadu_si128((const __m128i *)(solid + i));
+        moving = _mm_andnot_ps(_mm_castsi128_ps(lsolid), moving);
+        if (_mm_movemask_ps(moving) == 0) continue;
+
+        // SSE2 has no blend: select(mask, a, b) = (mask & a) | (~mask & b)
+        __m128 lx = _mm_loadu_ps(x + i);
+        __m128 ly = _mm_loadu_ps(y + i);
+        if (save) {
+            __m128i lstep = _mm_loadu_si128((const __m128i *)(prev_step + i));
+            __m128 saved = _mm_castsi128_ps(_mm_cmpeq_epi32(lstep, step4));
+            __m128 first = _mm_andnot_ps(saved, moving);
+            _mm_storeu_ps(px + i, _mm_or_ps(_mm_and_ps(first, lx),
+                                            _mm_andnot_ps(first, _mm_loadu_ps(px + i))));
+            _mm_storeu_ps(py + i, _mm_or_ps(_mm_and_ps(first, ly),
+                                            _mm_andnot_ps(first, _mm_loadu_ps(py + i))));
+            __m128i first_i = _mm_castps_si128(first);
+            _mm_storeu_si128((__m128i *)(prev_step + i),
+                             _mm_or_si128(_mm_and_si128(first_i, step4),
+                                          _mm_andnot_si128(first_i, lstep)));
+        }
+        lx = _mm_or_ps(_mm_and_ps(moving, _mm_add_ps(lx, lvx)), _mm_andnot_ps(moving, lx));
+        ly = _mm_or_ps(_mm_and_ps(moving, _mm_add_ps(ly, lvy)), _mm_andnot_ps(moving, ly));
+        _mm_storeu_ps(x + i, lx);
+        _mm_storeu_ps(y + i, ly);
+        __m128i lmoved = _mm_loadu_si128((const __m128i *)(moved + i));
+        _mm_storeu_si128((__m128i *)(moved + i),
+                         _mm_or_si128(lmoved, _mm_castps_si128(moving)));
+
+        __m128 outside = _mm_or_ps(_mm_or_ps(_mm_cmplt_ps(lx, l), _mm_cmpge_ps(lx, r)),
+                                   _mm_or_ps(_mm_cmplt_ps(ly, t), _mm_cmpge_ps(ly, b)));
+        int out_bits = _mm_movemask_ps(_mm_and_ps(outside, moving));
+        for (int lane = 0; out_bits != 0; lane++, out_bits >>= 1) {
+            if (out_bits & 1) out.insert(m_owner[i + lane]);
+        }
+    }
+#endif
+
+    // Scalar tail (or whole array without SSE2)
+    for (; i < n; i++) {
+        if (solid[i] || (vx[i] == 0.0f && vy[i] == 0.0f)) continue;
+        if (save && prev_step[i] != step) {
+            px[i] = x[i];
+            py[i] = y[i];
+            prev_step[i] = step;
+        }
+        x[i] += vx[i];
+        y[i] += vy[i];
+        moved[i] = -1;
+        if (x[i] < left || x[i] >= right || y[i] < top || y[i] >= bottom) {
+            out.insert(m_owner[i]);
+        }
+    }
+}
+
+} // end namespace df
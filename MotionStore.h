@@ -0,0 +1,124 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "Box.h"
+#include "Vector.h"
+
+namespace df {
+
+class Object;
+class ObjectList;
+
+// Motion state of every Object in structure-of-arrays form, so movement
+// can be integrated for many Objects at once with SIMD. Each Object owns
+// one slot; when a slot is freed the last slot moves into it and its
+// Object's index is updated, keeping the arrays dense. Slots of awake
+// Objects are kept first (swapping slots as Objects wake and sleep), so
+// per-update passes visit only those.
+class MotionStore {
+private:
+    std::vector<float> m_x, m_y;           // Position
+    std::vector<float> m_vx, m_vy;         // Velocity (spaces per step)
+    std::vector<float> m_px, m_py;         // Position before the step it last moved in
+    std::vector<std::int32_t> m_prev_step; // Step count when previous position saved
+    std::vector<std::int32_t> m_solid;     // -1 if Object is solid, else 0
+    std::vector<std::int32_t> m_moved;     // -1 if slot moved since takeMoved(), else 0
+    std::vector<Object *> m_owner;         // Object owning each slot
+    int m_awake_count;                     // Slots [0, m_awake_count) are awake
+
+    MotionStore(MotionStore const &);      // No copy
+    void operator=(MotionStore const &);   // No assign
+
+    // Exchange two slots, updating their Objects' indexes
+    void swapSlots(int a, int b);
+
+public:
+    MotionStore();
+
+    // Add an awake slot for p_o (at rest at the origin)
+    // Return slot index
+    int add(Object *p_o);
+
+    // Free slot at index (last slot moves into it)
+    void remove(int index);
+
+    // Return count of slots in use
+    int getCount() const;
+
+    // Move slot among the awake or asleep slots (its Object's index
+    // changes). Sleeping clears its moved mark.
+    void setAwake(int index, bool awake);
+
+    // Return count of awake slots (they are slots 0 to count - 1)
+    int getAwakeCount() const;
+
+    // Get/set position of slot
+    Vector getPosition(int index) const {
+        return Vector(m_x[index], m_y[index]);
+    }
+    void setPosition(int index, Vector new_pos) {
+        m_x[index] = new_pos.getX();
+        m_y[index] = new_pos.getY();
+    }
+
+    // Get/set velocity of slot
+    Vector getVelocity(int index) const {
+        return Vector(m_vx[index], m_vy[index]);
+    }
+    void setVelocity(int index, Vector new_velocity) {
+        m_vx[index] = new_velocity.getX();
+        m_vy[index] = new_velocity.getY();
+    }
+
+    // Return true if slot has non-zero velocity
+    bool isMoving(int index) const {
+        return m_vx[index] != 0.0f || m_vy[index] != 0.0f;
+    }
+
+    // Save current position as the previous one for step, unless already
+    // saved for step
+    void savePrevious(int index, int step) {
+        if (m_prev_step[index] != step) {
+            m_px[index] = m_x[index];
+            m_py[index] = m_y[index];
+            m_prev_step[index] = step;
+        }
+    }
+
+    // Get previous position and the step it was saved for
+    Vector getPrevious(int index) const {
+        return Vector(m_px[index], m_py[index]);
+    }
+    int getPreviousStep(int index) const {
+        return m_prev_step[index];
+    }
+
+    // Set whether slot's Object is solid (solid Objects are not moved by
+    // integrate(), as collisions can stop them)
+    void setSolid(int index, bool solid) {
+        m_solid[index] = solid ? -1 : 0;
+    }
+
+    // Append the Object of every awake solid slot with non-zero velocity
+    // to out
+    void collectSolidMovers(std::vector<Object *> &out) const;
+
+    // Mark awake slot moved, as integrate() does (safe from parallel
+    // steps, as each touches only its own slot)
+    void markMoved(int index) {
+        m_moved[index] = -1;
+    }
+
+    // Append the Object of every awake slot marked moved since the last
+    // call to out (only awake slots are checked)
+    void takeMoved(std::vector<Object *> &out);
+
+    // Move every awake non-solid slot with non-zero velocity by its velocity,
+    // four (SSE2) or eight (AVX2) slots at a time where available.
+    // Previous positions are saved for step (not if step is negative).
+    // Objects that end up outside bounds are appended to out.
+    void integrate(int step, const Box &bounds, ObjectList &out);
+};
+
+} // end namespace df
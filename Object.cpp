@@ -1,30 +1,60 @@
 #include "Object.h"
 #include "WorldManager.h"
+#include "GameManager.h"
+#include "InputManager.h"
 #include "DisplayManager.h"
 #include "LogManager.h"
+#include "Event.h"
+#include <cmath>
 
 namespace df {
 
 // Static counter for unique IDs
 static int object_count = 0;
 
+// Return Manager that dispatches events of given type
+Manager &Object::interestManager(int event_id) {
+    if (event_id == STEP_EVENT_ID) {
+        return GM;
+    }
+    if (event_id == KEYBOARD_EVENT_ID || event_id == MSE_EVENT_ID) {
+        return IM;
+    }
+    return WM;
+}
+
 Object::Object()
     : m_id(++object_count)
     , m_type("Object")
-    , m_position(0, 0)
+    , m_motion_index(WM.getMotion().add(this))
     , m_altitude(MAX_ALTITUDE / 2)
     , m_speed(0.0f)
     , m_direction(0, 0)
     , m_solidness(HARD)
+    , m_is_visible(true)
+    , m_is_drawn_in_view(false)
+    , m_is_awake(true)
+    , m_is_marked(false)
+    , m_step_thread_safe(false)
     , m_shape("*")
+    , m_box(Vector(0, 0), 1, 1)
+    , m_sweep_index(-1)
+    , m_visible_index(-1)
 {
+    WM.getMotion().setSolid(m_motion_index, isSolid());
     WM.insertObject(this);
-    LM.writeLog("Object::Object() - created object id %d", m_id);
+    DF_LOG_DEBUG("Object::Object() - created object id %d", m_id);
 }
 
 Object::~Object() {
-    LM.writeLog("Object::~Object() - destroying object id %d", m_id);
+    DF_LOG_DEBUG("Object::~Object() - destroying object id %d", m_id);
+    for (int event_id : m_interests) {
+        if (isListening(event_id)) {
+            interestManager(event_id).unregisterInterest(this, event_id);
+        }
+    }
     WM.removeObject(this);
+    WM.getMotion().remove(m_motion_index);
 }
 
 void Object::setId(int new_id) {
@@ -36,25 +66,48 @@ int Object::getId() const {
 }
 
 void Object::setType(std::string new_type) {
+    std::string old_type = m_type;
     m_type = new_type;
+    WM.onTypeChange(this, old_type);
 }
 
-std::string Object::getType() const {
+const std::string &Object::getType() const {
     return m_type;
 }
 
+// Saves the position the first time the Object moves in a step, so
+// drawing can interpolate from it (moves outside steps draw as is).
 void Object::setPosition(Vector new_pos) {
-    m_position = new_pos;
+    MotionStore &motion = WM.getMotion();
+    if (GM.isStepping()) {
+        motion.savePrevious(m_motion_index, GM.getStepCount());
+    }
+    motion.setPosition(m_motion_index, new_pos);
+    WM.onBoxChange(this);
 }
 
 Vector Object::getPosition() const {
-    return m_position;
+    return WM.getMotion().getPosition(m_motion_index);
+}
+
+Vector Object::getDrawPosition() const {
+    const MotionStore &motion = WM.getMotion();
+    Vector position = motion.getPosition(m_motion_index);
+    if (motion.getPreviousStep(m_motion_index) != GM.getStepCount()) {
+        return position;
+    }
+    Vector prev_position = motion.getPrevious(m_motion_index);
+    Vector moved = position - prev_position;
+    moved.scale(GM.getAlpha());
+    return prev_position + moved;
 }
 
 // BUG FIX: Original returned 1 on error instead of -1
 int Object::setAltitude(int new_altitude) {
     if (new_altitude >= 0 && new_altitude <= MAX_ALTITUDE) {
+        int old_altitude = m_altitude;
         m_altitude = new_altitude;
+        WM.onAltitudeChange(this, old_altitude);
         return 0;
     }
     return -1;
@@ -66,6 +119,7 @@ int Object::getAltitude() const {
 
 void Object::setSpeed(float speed) {
     m_speed = speed;
+    storeVelocity();
 }
 
 float Object::getSpeed() const {
@@ -74,6 +128,7 @@ float Object::getSpeed() const {
 
 void Object::setDirection(Vector new_direction) {
     m_direction = new_direction;
+    storeVelocity();
 }
 
 Vector Object::getDirection() const {
@@ -85,23 +140,62 @@ void Object::setVelocity(Vector new_velocity) {
     Vector direction = new_velocity;
     direction.normalize();
     m_direction = direction;
+    storeVelocity();
 }
 
 Vector Object::getVelocity() const {
+    return WM.getMotion().getVelocity(m_motion_index);
+}
+
+void Object::storeVelocity() {
     Vector velocity = m_direction;
     velocity.scale(m_speed);
-    return velocity;
+    WM.getMotion().setVelocity(m_motion_index, velocity);
+    if (!m_is_awake && WM.getMotion().isMoving(m_motion_index)) {
+        setAwake(true);
+    }
 }
 
 // BUG FIX: Original predictPosition only added speed (scalar) to both x and y
 // independently, ignoring direction entirely. Fixed to add velocity vector.
 Vector Object::predictPosition() {
+    Vector position = getPosition();
     Vector velocity = getVelocity();
-    Vector new_pos(m_position.getX() + velocity.getX(),
-                   m_position.getY() + velocity.getY());
+    Vector new_pos(position.getX() + velocity.getX(),
+                   position.getY() + velocity.getY());
     return new_pos;
 }
 
+void Object::setShape(std::string new_shape) {
+    m_shape = new_shape;
+    float width = new_shape.empty() ? 1.0f : (float)new_shape.size();
+    m_box = Box(Vector(0, 0), width, 1);
+    WM.onBoxChange(this);
+}
+
+std::string Object::getShape() const {
+    return m_shape;
+}
+
+void Object::setBox(Box new_box) {
+    m_box = new_box;
+    WM.onBoxChange(this);
+}
+
+Box Object::getBox() const {
+    return m_box;
+}
+
+Box Object::getWorldBox() const {
+    return getWorldBox(getPosition());
+}
+
+// Boxes are placed by cell, as drawing is, so the default box covers
+// exactly the cell the Object is drawn in.
+Box Object::getWorldBox(Vector pos) const {
+    return m_box.translated(Vector(std::floor(pos.getX()), std::floor(pos.getY())));
+}
+
 bool Object::isSolid() const {
     return (m_solidness == HARD || m_solidness == SOFT);
 }
@@ -113,7 +207,10 @@ int Object::setSolidness(Solidness new_solid) {
     if (new_solid != HARD && new_solid != SOFT && new_solid != SPECTRAL) {
         return -1;
     }
+    bool was_solid = isSolid();
     m_solidness = new_solid;
+    WM.getMotion().setSolid(m_motion_index, isSolid());
+    WM.onSolidnessChange(this, was_solid);
     return 0;
 }
 
@@ -121,12 +218,101 @@ Solidness Object::getSolidness() const {
     return m_solidness;
 }
 
+void Object::setVisible(bool new_visible) {
+    if (m_is_visible == new_visible) return;
+    m_is_visible = new_visible;
+    WM.onVisibilityChange(this);
+}
+
+void Object::setStepThreadSafe(bool new_thread_safe) {
+    m_step_thread_safe = new_thread_safe;
+}
+
+bool Object::isStepThreadSafe() const {
+    return m_step_thread_safe;
+}
+
+// An asleep Object stays registered for step events but is taken out of
+// GameManager's list, so steps don't visit it.
+void Object::setAwake(bool new_awake) {
+    if (m_is_awake == new_awake) return;
+    m_is_awake = new_awake;
+    for (int event_id : m_interests) {
+        if (event_id != STEP_EVENT_ID) continue;
+        if (new_awake) {
+            GM.registerInterest(this, event_id);
+        } else {
+            GM.unregisterInterest(this, event_id);
+        }
+    }
+    WM.onAwakeChange(this);
+}
+
+bool Object::isAwake() const {
+    return m_is_awake;
+}
+
+bool Object::isListening(int event_id) const {
+    return m_is_awake || event_id != STEP_EVENT_ID;
+}
+
+bool Object::isMarkedForDelete() const {
+    return m_is_marked;
+}
+
+bool Object::isVisible() const {
+    return m_is_visible;
+}
+
+void Object::setDrawnInView(bool new_drawn_in_view) {
+    if (m_is_drawn_in_view == new_drawn_in_view) return;
+    m_is_drawn_in_view = new_drawn_in_view;
+    WM.onVisibilityChange(this);
+}
+
+bool Object::isDrawnInView() const {
+    return m_is_drawn_in_view;
+}
+
+int Object::registerInterest(int event_id) {
+    for (int registered : m_interests) {
+        if (registered == event_id) {
+            return 0; // already registered
+        }
+    }
+    if (isListening(event_id) &&
+        interestManager(event_id).registerInterest(this, event_id) != 0) {
+        return -1;
+    }
+    m_interests.push_back(event_id);
+    return 0;
+}
+
+int Object::registerInterest(std::string event_type) {
+    return registerInterest(Event::registerType(event_type));
+}
+
+int Object::unregisterInterest(int event_id) {
+    for (size_t i = 0; i < m_interests.size(); i++) {
+        if (m_interests[i] == event_id) {
+            m_interests.erase(m_interests.begin() + i);
+            if (!isListening(event_id)) return 0;
+            return interestManager(event_id).unregisterInterest(this, event_id);
+        }
+    }
+    return -1; // not registered
+}
+
+int Object::unregisterInterest(std::string event_type) {
+    return unregisterInterest(Event::registerType(event_type));
+}
+
 int Object::eventHandler(const Event */*p_e*/) {
     return 0; // Base class does not handle events
 }
 
 int Object::draw() {
-    DM.drawString(m_position, m_shape, LEFT_JUSTIFIED, GREEN);
+    DM.drawString(getDrawPosition(), m_shape, LEFT_JUSTIFIED, GREEN, m_is_drawn_in_view);
     return 0;
 }
 
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <string>
+#include <vector>
+#include "Box.h"
 #include "Vector.h"
 #include "Event.h"
 
@@ -8,6 +10,8 @@ const int MAX_ALTITUDE = 4; // Maximum object altitude (0-4)
 
 namespace df {
 
+class Manager;
+
 // Solidness of object
 enum Solidness {
     HARD,       // Object causes collisions and impedes movement
@@ -19,12 +23,37 @@ class Object {
 private:
     int m_id;              // Unique identifier
     std::string m_type;    // Game-programmer-defined type
-    Vector m_position;     // Position in game world
+    int m_motion_index;    // Slot holding position and velocity in WM's MotionStore
     int m_altitude;        // Altitude (layer): 0 to MAX_ALTITUDE
     float m_speed;         // Speed in direction
     Vector m_direction;    // Direction of object
     Solidness m_solidness; // Solidness of object
+    bool m_is_visible;     // True if drawn (hidden Objects skip draw())
+    bool m_is_drawn_in_view; // True if position and box are in view spaces
+    bool m_is_awake;       // True if moved and stepped each update
+    bool m_is_marked;      // True once marked for delete
+    bool m_step_thread_safe; // True if step handler may run on a worker thread
     std::string m_shape;   // Simple ASCII shape (used in draw())
+    Box m_box;             // Collision box, relative to position's cell
+    int m_sweep_index;     // Slot in WorldManager's sorted solid boxes (-1 if none)
+    int m_visible_index;   // Slot in WorldManager's sorted visible boxes (-1 if none)
+    std::vector<int> m_interests; // Event type ids registered for
+
+    // WorldManager removes marked Objects from every list in batches
+    friend class WorldManager;
+
+    // MotionStore renumbers m_motion_index when slots move
+    friend class MotionStore;
+
+    // Store speed * direction as velocity in the MotionStore
+    void storeVelocity();
+
+    // Return Manager that dispatches events of type event_id
+    static Manager &interestManager(int event_id);
+
+    // Return true if Object should be in its Manager's list for event_id
+    // (asleep Objects are left out of step events)
+    bool isListening(int event_id) const;
 
 public:
     // Construct Object. Add to WorldManager.
@@ -43,7 +72,7 @@ public:
     void setType(std::string new_type);
 
     // Get type identifier of Object
-    std::string getType() const;
+    const std::string &getType() const;
 
     // Set position of Object
     void setPosition(Vector new_pos);
@@ -58,27 +87,50 @@ public:
     // Return altitude of Object
     int getAltitude() const;
 
-    // Set speed of Object
+    // Set speed of Object (waking it if that sets it moving)
     void setSpeed(float speed);
 
     // Get speed of Object
     float getSpeed() const;
 
-    // Set direction of Object
+    // Set direction of Object (waking it if that sets it moving)
     void setDirection(Vector new_direction);
 
     // Get direction of Object
     Vector getDirection() const;
 
-    // Set velocity (speed + direction) of Object
+    // Set velocity (speed + direction) of Object (waking it if non-zero)
     void setVelocity(Vector new_velocity);
 
     // Get velocity (speed * direction) of Object
     Vector getVelocity() const;
 
-    // Predict position based on speed and direction
+    // Get position to draw at: between the previous and current step's
+    // positions by GM's interpolation factor if moved in the last step
+    Vector getDrawPosition() const;
+
+    // Predict position after one step based on speed and direction
+    // (velocity is in spaces per simulation step)
     Vector predictPosition();
 
+    // Set shape drawn by draw(); also sets the box to the shape's width
+    // (one row high)
+    void setShape(std::string new_shape);
+
+    // Get shape drawn by draw()
+    std::string getShape() const;
+
+    // Set collision box, relative to the corner of the cell the position
+    // is in (default from the shape: one space per character)
+    void setBox(Box new_box);
+
+    // Get collision box, relative to position's cell
+    Box getBox() const;
+
+    // Get collision box in world coordinates, at position or as if at pos
+    Box getWorldBox() const;
+    Box getWorldBox(Vector pos) const;
+
     // Return true if Object is HARD or SOFT (solid)
     bool isSolid() const;
 
@@ -89,10 +141,60 @@ public:
     // Return solidness of Object
     Solidness getSolidness() const;
 
+    // Register for interest in event type. Step events come from
+    // GameManager, keyboard and mouse events from InputManager, and all
+    // other (user-defined) events from WorldManager::onEvent.
+    // Return 0 if ok, else -1
+    int registerInterest(int event_id);
+    int registerInterest(std::string event_type);
+
+    // Unregister for interest in event type
+    // Return 0 if ok, else -1
+    int unregisterInterest(int event_id);
+    int unregisterInterest(std::string event_type);
+
+    // Set whether Object's step event handler is thread-safe. Thread-safe
+    // handlers run in parallel on GameManager's job threads, before the
+    // others run in order. They may change the Object's own members,
+    // velocity and (if not solid) position, and may log; they must not
+    // create, delete or mark Objects, register interests or touch other
+    // Objects. Not to be changed from inside a step handler.
+    void setStepThreadSafe(bool new_thread_safe = true);
+
+    // Return true if Object's step event handler is thread-safe
+    bool isStepThreadSafe() const;
+
+    // Return true if Object is marked for delete (WM.markForDelete())
+    bool isMarkedForDelete() const;
+
+    // Set visibility of Object (invisible Objects are not drawn)
+    void setVisible(bool new_visible = true);
+
+    // Return true if Object is visible
+    bool isVisible() const;
+
+    // Set whether Object's position and box are in view spaces, not world
+    // spaces (default false). Such Objects (e.g. a HUD) are drawn with
+    // in_view and stay put on screen as the view moves.
+    void setDrawnInView(bool new_drawn_in_view = true);
+
+    // Return true if Object's position and box are in view spaces
+    bool isDrawnInView() const;
+
+    // Wake or put Object to sleep (default awake). Asleep Objects are
+    // skipped by movement and step events, so idle ones cost nothing per
+    // update, but are still drawn, collided with and sent other events.
+    // Objects wake when given a non-zero velocity or in a collision. Not
+    // to be called from a thread-safe step handler.
+    void setAwake(bool new_awake = true);
+
+    // Return true if Object is awake
+    bool isAwake() const;
+
     // Handle event. Return 1 if handled, 0 if not.
     virtual int eventHandler(const Event *p_e);
 
-    // Draw Object (default: draw shape string at position)
+    // Draw Object (default: draw shape string at draw position)
     virtual int draw();
 };
 
@@ -1,59 +1,249 @@
 #include "ObjectList.h"
 #include "Object.h"
+#include <algorithm>
 
 namespace df {
 
-ObjectList::ObjectList() : m_count(0) {
-    for (int i = 0; i < MAX_OBJECTS; i++) {
-        m_p_obj[i] = nullptr;
+ObjectList::ObjectList()
+    : m_key_count(0)
+    , m_view_count(0)
+    , m_hole_count(0)
+    , m_is_dense(false)
+{}
+
+ObjectList::ObjectList(const ObjectList &other)
+    : m_key_count(0)
+    , m_view_count(0)
+    , m_hole_count(0)
+    , m_is_dense(false)
+{
+    *this = other;
+}
+
+ObjectList &ObjectList::operator=(const ObjectList &other) {
+    if (this == &other) return *this;
+    m_p_obj.clear();
+    m_p_obj.reserve(other.m_p_obj.size() - other.m_hole_count);
+    resetKeys(other.getCount());
+    for (Object *p_o : other.m_p_obj) {
+        if (p_o != nullptr) {
+            setSlot(p_o, (int)m_p_obj.size());
+            m_p_obj.push_back(p_o);
+        }
     }
+    m_hole_count = 0;
+    m_is_dense = false;
+    return *this;
 }
 
 int ObjectList::insert(Object *p_o) {
-    if (isFull()) {
-        return -1;
+    if (!m_keys.empty() && m_keys[findKey(p_o)].p_o != nullptr) {
+        return -1; // already in list
     }
-    m_p_obj[m_count] = p_o;
-    m_count++;
+    setSlot(p_o, (int)m_p_obj.size());
+    if (m_is_dense) {
+        m_dense.push_back((int)m_p_obj.size());
+    }
+    m_p_obj.push_back(p_o);
     return 0;
 }
 
+// The last element is swapped into the freed slot (and its slot noted).
 int ObjectList::remove(Object *p_o) {
-    for (int i = 0; i < m_count; i++) {
-        if (m_p_obj[i] == p_o) {
-            // Shift remaining elements left
-            for (int j = i; j < m_count - 1; j++) {
-                m_p_obj[j] = m_p_obj[j + 1];
+    if (p_o == nullptr || m_keys.empty()) return -1;
+    int key = findKey(p_o);
+    if (m_keys[key].p_o == nullptr) return -1; // not found
+    int slot = m_keys[key].slot;
+    eraseKey(p_o);
+    if (m_view_count > 0) {
+        // Don't move elements under a live view
+        m_p_obj[slot] = nullptr;
+        m_hole_count++;
+        if (m_is_dense) {
+            m_dense.erase(std::lower_bound(m_dense.begin(), m_dense.end(), slot));
+        }
+    } else {
+        Object *p_last = m_p_obj.back();
+        m_p_obj[slot] = p_last;
+        m_p_obj.pop_back();
+        if (slot < (int)m_p_obj.size()) {
+            setSlot(p_last, slot);
+        }
+    }
+    return 0;
+}
+
+int ObjectList::removeMarked() {
+    int removed = 0;
+    if (m_view_count > 0) {
+        for (Object *&p_o : m_p_obj) {
+            if (p_o != nullptr && p_o->isMarkedForDelete()) {
+                eraseKey(p_o);
+                p_o = nullptr;
+                m_hole_count++;
+                removed++;
             }
-            m_p_obj[m_count - 1] = nullptr;
-            m_count--;
-            return 0;
         }
+        m_is_dense = false;
+        return removed;
     }
-    return -1; // not found
+    // As remove(): the last element fills each freed slot, so only the
+    // Objects that move get their slot rewritten
+    int i = 0;
+    while (i < (int)m_p_obj.size()) {
+        if (!m_p_obj[i]->isMarkedForDelete()) {
+            i++;
+            continue;
+        }
+        eraseKey(m_p_obj[i]);
+        removed++;
+        m_p_obj[i] = m_p_obj.back();
+        m_p_obj.pop_back();
+        if (i < (int)m_p_obj.size()) {
+            setSlot(m_p_obj[i], i);
+        }
+    }
+    return removed;
 }
 
 void ObjectList::clear() {
-    m_count = 0;
+    m_p_obj.clear();
+    if (m_key_count > 0) resetKeys(0);
+    m_hole_count = 0;
+    m_is_dense = false;
+}
+
+void ObjectList::reserve(int new_capacity) {
+    if (new_capacity > 0) {
+        m_p_obj.reserve(new_capacity);
+        if (new_capacity * 2 > (int)m_keys.size()) {
+            resetKeys(new_capacity);
+            for (int i = 0; i < (int)m_p_obj.size(); i++) {
+                if (m_p_obj[i] != nullptr) setSlot(m_p_obj[i], i);
+            }
+        }
+    }
 }
 
 int ObjectList::getCount() const {
-    return m_count;
+    return (int)m_p_obj.size() - m_hole_count;
 }
 
 bool ObjectList::isEmpty() const {
-    return (m_count == 0);
+    return (m_p_obj.size() == (size_t)m_hole_count);
 }
 
 bool ObjectList::isFull() const {
-    return (m_count >= MAX_OBJECTS);
+    return false;
+}
+
+bool ObjectList::isViewed() const {
+    return (m_view_count > 0);
 }
 
 Object *ObjectList::operator[](int index) const {
-    if (index < 0 || index >= m_count) {
+    if (index < 0 || index >= getCount()) {
         return nullptr;
     }
+    if (m_hole_count == 0) {
+        return m_p_obj[index];
+    }
+    if (!m_is_dense) {
+        m_dense.clear();
+        for (int i = 0; i < (int)m_p_obj.size(); i++) {
+            if (m_p_obj[i] != nullptr) m_dense.push_back(i);
+        }
+        m_is_dense = true;
+    }
+    return m_p_obj[m_dense[index]];
+}
+
+int ObjectList::getSlotCount() const {
+    return (int)m_p_obj.size();
+}
+
+Object *ObjectList::getSlot(int index) const {
     return m_p_obj[index];
 }
 
+// Pointers are hashed by multiplying (Fibonacci hashing); the low bits
+// are dropped first, as they are the same for every aligned Object.
+int ObjectList::homeKey(const Object *p_o) const {
+    std::uint64_t hash = ((std::uint64_t)(std::uintptr_t)p_o >> 3) * 0x9E3779B97F4A7C15ull;
+    return (int)(hash >> 32) & ((int)m_keys.size() - 1);
+}
+
+int ObjectList::findKey(const Object *p_o) const {
+    int mask = (int)m_keys.size() - 1;
+    int key = homeKey(p_o);
+    while (m_keys[key].p_o != nullptr && m_keys[key].p_o != p_o) {
+        key = (key + 1) & mask;
+    }
+    return key;
+}
+
+// The table doubles once it would be more than half full.
+void ObjectList::setSlot(const Object *p_o, int slot) {
+    if ((m_key_count + 1) * 2 > (int)m_keys.size()) {
+        std::vector<SlotKey> keys;
+        keys.swap(m_keys);
+        resetKeys(m_key_count + 1);
+        for (const SlotKey &entry : keys) {
+            if (entry.p_o != nullptr) setSlot(entry.p_o, entry.slot);
+        }
+    }
+    SlotKey &entry = m_keys[findKey(p_o)];
+    if (entry.p_o == nullptr) {
+        entry.p_o = p_o;
+        m_key_count++;
+    }
+    entry.slot = slot;
+}
+
+// Entries after the freed one that can't be found past the gap (their
+// home entry is not between the gap and them) are shifted back into it.
+void ObjectList::eraseKey(const Object *p_o) {
+    if (m_keys.empty()) return;
+    int gap = findKey(p_o);
+    if (m_keys[gap].p_o == nullptr) return;
+    int mask = (int)m_keys.size() - 1;
+    m_keys[gap].p_o = nullptr;
+    for (int next = (gap + 1) & mask; m_keys[next].p_o != nullptr; next = (next + 1) & mask) {
+        int home = homeKey(m_keys[next].p_o);
+        if (((next - home) & mask) >= ((next - gap) & mask)) {
+            m_keys[gap] = m_keys[next];
+            m_keys[next].p_o = nullptr;
+            gap = next;
+        }
+    }
+    m_key_count--;
+}
+
+void ObjectList::resetKeys(int count) {
+    int size = 8;
+    while (size < count * 2) size *= 2;
+    m_keys.assign(size, SlotKey{nullptr, 0});
+    m_key_count = 0;
+}
+
+void ObjectList::beginView() {
+    m_view_count++;
+}
+
+// Compact holes in one pass, keeping the order of the remaining objects.
+void ObjectList::endView() {
+    m_view_count--;
+    if (m_view_count > 0 || m_hole_count == 0) return;
+    size_t out = 0;
+    for (size_t i = 0; i < m_p_obj.size(); i++) {
+        if (m_p_obj[i] != nullptr) {
+            if (out != i) setSlot(m_p_obj[i], (int)out);
+            m_p_obj[out++] = m_p_obj[i];
+        }
+    }
+    m_p_obj.resize(out);
+    m_hole_count = 0;
+    m_is_dense = false;
+}
+
 } // end namespace df
@@ -1,42 +1,108 @@
 #pragma once
 
-const int MAX_OBJECTS = 1000;
+#include <cstdint>
+#include <vector>
+
+// Slots reserved up front by lists that expect to hold many Objects
+const int OBJECT_LIST_RESERVE_DEFAULT = 1024;
 
 // Forward declare to break circular dependency with WorldManager
-namespace df { class Object; }
+namespace df { class Object; class ObjectListView; }
 
 namespace df {
 
 class ObjectList {
 private:
-    int m_count;                    // Count of objects in list
-    Object *m_p_obj[MAX_OBJECTS];   // Array of pointers to Objects
+    std::vector<Object *> m_p_obj;  // Pointers to Objects (grows as needed)
+    // Slot of each Object in m_p_obj, in an open-addressing hash table
+    // (linear probing, size a power of two, at most half full)
+    struct SlotKey {
+        const Object *p_o;              // Object (nullptr if entry free)
+        int slot;                       // Its slot in m_p_obj
+    };
+    std::vector<SlotKey> m_keys;
+    int m_key_count;                    // Entries in use
+    int m_view_count;               // Live ObjectListViews over this list
+    int m_hole_count;               // Slots emptied while a view was live
+
+    // While there are holes: slot of each live Object, in order, so
+    // operator[] stays O(1). Built by the first operator[] after holes
+    // appear, kept up to date until they are compacted.
+    mutable std::vector<int> m_dense;
+    mutable bool m_is_dense;
+
+    friend class ObjectListView;
+
+    // Called by ObjectListView: while any view is live, remove() leaves a
+    // nullptr hole instead of moving elements. Holes are compacted when
+    // the last view ends.
+    void beginView();
+    void endView();
+
+    // Called by ObjectListView: count of slots and the Object in a slot,
+    // holes included
+    int getSlotCount() const;
+    Object *getSlot(int index) const;
+
+    // Return table entry p_o's search starts at
+    int homeKey(const Object *p_o) const;
+
+    // Return table entry holding p_o, or the free entry where it belongs
+    int findKey(const Object *p_o) const;
+
+    // Note p_o is in slot (adding it to the table if needed)
+    void setSlot(const Object *p_o, int slot);
+
+    // Drop p_o from the table (if there)
+    void eraseKey(const Object *p_o);
+
+    // Empty the table, sized for at least count Objects
+    void resetKeys(int count);
 
 public:
-    // Default constructor
+    // Default constructor (empty, no capacity reserved)
     ObjectList();
 
-    // Insert object pointer in list
-    // Return 0 if ok, else -1
+    // Copy live objects only (holes and views are not copied)
+    ObjectList(const ObjectList &other);
+    ObjectList &operator=(const ObjectList &other);
+
+    // Insert object pointer in list (an Object is in a list at most once)
+    // Return 0 if ok, else -1 (already in list)
     int insert(Object *p_o);
 
-    // Remove object pointer from list
+    // Remove object pointer from list in O(1): its slot is looked up and
+    // the last element is swapped into it, so order is not preserved
     // Return 0 if found and removed, else -1
     int remove(Object *p_o);
 
-    // Clear list (set count to 0)
+    // Remove every Object marked for delete in one pass (the last
+    // elements fill their slots, as for remove(); while a view is live
+    // they become nullptr holes)
+    // Return count removed
+    int removeMarked();
+
+    // Clear list (set count to 0, capacity is kept)
     void clear();
 
-    // Return count of objects in list
+    // Reserve room for at least new_capacity objects
+    void reserve(int new_capacity);
+
+    // Return count of Objects in list (holes left under a live view are
+    // not counted)
     int getCount() const;
 
     // Return true if list is empty
     bool isEmpty() const;
 
-    // Return true if list is full
+    // Return true if list is full (never, list grows without a cap)
     bool isFull() const;
 
-    // Index into list (no bounds check for speed)
+    // Return true while an ObjectListView is iterating over the list
+    bool isViewed() const;
+
+    // Index into list, nullptr if out of range. Holes left under a live
+    // view are skipped, so indexes stay dense.
     Object *operator[](int index) const;
 };
 
@@ -0,0 +1,56 @@
+#include "ObjectListView.h"
+
+namespace df {
+
+ObjectListView::ObjectListView(ObjectList &list)
+    : m_p_list(&list)
+    , m_end(list.getSlotCount())
+{
+    m_p_list->beginView();
+}
+
+ObjectListView::~ObjectListView() {
+    m_p_list->endView();
+}
+
+ObjectListView::Iterator ObjectListView::begin() const {
+    return Iterator(this, 0);
+}
+
+ObjectListView::Iterator ObjectListView::end() const {
+    return Iterator(this, m_end);
+}
+
+ObjectListView::Iterator::Iterator(const ObjectListView *p_view, int index)
+    : m_p_view(p_view)
+    , m_index(index)
+{
+    skipHoles();
+}
+
+// Also stops early if the list was cleared under the view.
+void ObjectListView::Iterator::skipHoles() {
+    const ObjectList &list = *m_p_view->m_p_list;
+    int end = m_p_view->m_end;
+    if (end > list.getSlotCount()) end = list.getSlotCount();
+    while (m_index < end && list.getSlot(m_index) == nullptr) {
+        m_index++;
+    }
+    if (m_index >= end) m_index = m_p_view->m_end;
+}
+
+Object *ObjectListView::Iterator::operator*() const {
+    return m_p_view->m_p_list->getSlot(m_index);
+}
+
+ObjectListView::Iterator &ObjectListView::Iterator::operator++() {
+    m_index++;
+    skipHoles();
+    return *this;
+}
+
+bool ObjectListView::Iterator::operator!=(const Iterator &other) const {
+    return m_index != other.m_index;
+}
+
+} // end namespace df
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "ObjectList.h"
+
+namespace df {
+
+// Non-owning view for iterating over an ObjectList without copying it:
+//
+//   for (Object *p_o : ObjectListView(list)) { ... }
+//
+// Objects removed from the list while the view is live are skipped.
+// Objects inserted while the view is live are not visited. Holes left
+// by removals are compacted when the last view of a list ends, so a view
+// changes its list and can only be made over a non-const one.
+class ObjectListView {
+private:
+    ObjectList *m_p_list;  // List being iterated (not owned)
+    int m_end;             // Count of list when view was created
+
+public:
+    // Begin viewing list
+    explicit ObjectListView(ObjectList &list);
+
+    // End view (list compacts any holes left by removals)
+    ~ObjectListView();
+
+    ObjectListView(ObjectListView const &) = delete;             // No copy
+    ObjectListView &operator=(ObjectListView const &) = delete;  // No assign
+
+    class Iterator {
+    private:
+        const ObjectListView *m_p_view; // View being iterated
+        int m_index;                    // Current slot in list
+
+        // Advance past removed (nullptr) slots
+        void skipHoles();
+
+    public:
+        Iterator(const ObjectListView *p_view, int index);
+
+        // Return current Object
+        Object *operator*() const;
+
+        // Advance to next live Object
+        Iterator &operator++();
+
+        // Return true if iterators are at different slots
+        bool operator!=(const Iterator &other) const;
+    };
+
+    // Return iterator to first live Object
+    Iterator begin() const;
+
+    // Return iterator past last visited slot
+    Iterator end() const;
+};
+
+} // end namespace df
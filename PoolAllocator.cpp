@@ -0,0 +1,104 @@
+#include "PoolAllocator.h"
+#include <new>
+
+namespace df {
+
+PoolAllocator::PoolAllocator(size_t block_size) {
+    if (block_size < sizeof(FreeBlock)) {
+        block_size = sizeof(FreeBlock);
+    }
+    m_block_size = (block_size + POOL_GRANULARITY - 1) / POOL_GRANULARITY * POOL_GRANULARITY;
+    m_slab_blocks = POOL_SLAB_BYTES / m_block_size;
+    if (m_slab_blocks < POOL_MIN_SLAB_BLOCKS) {
+        m_slab_blocks = POOL_MIN_SLAB_BLOCKS;
+    }
+    m_p_free = nullptr;
+    m_in_use = 0;
+}
+
+PoolAllocator::~PoolAllocator() {
+    for (char *p_slab : m_slabs) {
+        ::operator delete(p_slab);
+    }
+}
+
+// Blocks are linked in address order so a fresh slab hands them out
+// sequentially.
+void PoolAllocator::grow() {
+    char *p_slab = static_cast<char *>(::operator new(m_block_size * m_slab_blocks));
+    m_slabs.push_back(p_slab);
+    for (size_t i = m_slab_blocks; i > 0; i--) {
+        FreeBlock *p_block = reinterpret_cast<FreeBlock *>(p_slab + (i - 1) * m_block_size);
+        p_block->p_next = m_p_free;
+        m_p_free = p_block;
+    }
+}
+
+void *PoolAllocator::allocate() {
+    if (m_p_free == nullptr) {
+        grow();
+    }
+    FreeBlock *p_block = m_p_free;
+    m_p_free = p_block->p_next;
+    m_in_use++;
+    return p_block;
+}
+
+void PoolAllocator::deallocate(void *p) {
+    if (p == nullptr) {
+        return;
+    }
+    FreeBlock *p_block = static_cast<FreeBlock *>(p);
+    p_block->p_next = m_p_free;
+    m_p_free = p_block;
+    m_in_use--;
+}
+
+size_t PoolAllocator::getBlockSize() const {
+    return m_block_size;
+}
+
+size_t PoolAllocator::getInUse() const {
+    return m_in_use;
+}
+
+size_t PoolAllocator::getSlabCount() const {
+    return m_slabs.size();
+}
+
+// One pool per POOL_GRANULARITY step up to POOL_MAX_BLOCK, created on
+// first use and kept for the life of the program.
+PoolAllocator *poolFor(size_t size) {
+    static const size_t CLASS_COUNT = POOL_MAX_BLOCK / POOL_GRANULARITY;
+    static PoolAllocator *pools[CLASS_COUNT] = {};
+    if (size == 0) {
+        size = 1;
+    }
+    if (size > POOL_MAX_BLOCK) {
+        return nullptr;
+    }
+    size_t index = (size - 1) / POOL_GRANULARITY;
+    if (pools[index] == nullptr) {
+        pools[index] = new PoolAllocator((index + 1) * POOL_GRANULARITY);
+    }
+    return pools[index];
+}
+
+void *poolAllocate(size_t size) {
+    PoolAllocator *p_pool = poolFor(size);
+    if (p_pool == nullptr) {
+        return ::operator new(size);
+    }
+    return p_pool->allocate();
+}
+
+void poolDeallocate(void *p, size_t size) {
+    PoolAllocator *p_pool = poolFor(size);
+    if (p_pool == nullptr) {
+        ::operator delete(p);
+        return;
+    }
+    p_pool->deallocate(p);
+}
+
+} // end namespace df
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// Pool block sizes are multiples of this (also their alignment)
+const size_t POOL_GRANULARITY = 16;
+
+// Largest block size served from pools; bigger requests use the heap
+const size_t POOL_MAX_BLOCK = 512;
+
+// Target bytes per slab (at least POOL_MIN_SLAB_BLOCKS blocks)
+const size_t POOL_SLAB_BYTES = 64 * 1024;
+const size_t POOL_MIN_SLAB_BLOCKS = 16;
+
+namespace df {
+
+// Fixed-size block allocator: blocks are carved from contiguous slabs
+// and recycled through an intrusive free list. Slabs are only released
+// when the allocator is destroyed. Not thread-safe.
+class PoolAllocator {
+private:
+    // Free block (its storage holds the link)
+    struct FreeBlock {
+        FreeBlock *p_next;
+    };
+
+    size_t m_block_size;           // Bytes per block
+    size_t m_slab_blocks;          // Blocks per slab
+    FreeBlock *m_p_free;           // Head of free list
+    std::vector<char *> m_slabs;   // Slabs allocated so far
+    size_t m_in_use;               // Blocks handed out
+
+    PoolAllocator(PoolAllocator const &);  // No copy
+    void operator=(PoolAllocator const &); // No assign
+
+    // Allocate a new slab and put its blocks on the free list
+    void grow();
+
+public:
+    // Create allocator for blocks of block_size bytes (rounded up to
+    // POOL_GRANULARITY)
+    explicit PoolAllocator(size_t block_size);
+
+    // Release all slabs
+    ~PoolAllocator();
+
+    // Return a free block, adding a slab if none is left
+    void *allocate();
+
+    // Return block p (from allocate()) to the free list
+    void deallocate(void *p);
+
+    // Get bytes per block
+    size_t getBlockSize() const;
+
+    // Get count of blocks handed out and not yet returned
+    size_t getInUse() const;
+
+    // Get count of slabs allocated
+    size_t getSlabCount() const;
+};
+
+// Allocate size bytes from the size-class pool that fits, or the heap if
+// size is over POOL_MAX_BLOCK. Must be freed with poolDeallocate(p, size).
+void *poolAllocate(size_t size);
+
+// Free p, allocated by poolAllocate() with the same size
+void poolDeallocate(void *p, size_t size);
+
+// Return the size-class pool serving size, nullptr if over POOL_MAX_BLOCK
+PoolAllocator *poolFor(size_t size);
+
+// Opt-in pooled allocation: derive an Object subclass from Pooled as well
+// (class Bullet : public df::Object, public df::Pooled) and new/delete of
+// that class go through the size-class pools. Objects deleted by the
+// WorldManager return their memory to the pool too.
+class Pooled {
+public:
+    static void *operator new(size_t size) {
+        return poolAllocate(size);
+    }
+
+    static void operator delete(void *p, size_t size) {
+        poolDeallocate(p, size);
+    }
+};
+
+} // end namespace df
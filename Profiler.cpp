@@ -0,0 +1,117 @@
+#include "Profiler.h"
+#include <algorithm>
+#include <cstdio>
+
+namespace df {
+
+Profiler::Profiler()
+    : m_start(std::chrono::steady_clock::now())
+    , m_enabled(true)
+    , m_frame(0)
+{
+}
+
+Profiler &Profiler::getInstance() {
+    static Profiler instance;
+    return instance;
+}
+
+// Rings are never freed, so the cached pointer stays valid for the
+// thread's lifetime.
+Profiler::ThreadRing *Profiler::threadRing() {
+    thread_local ThreadRing *p_ring = nullptr;
+    if (p_ring == nullptr) {
+        std::lock_guard<std::mutex> lock(m_rings_mutex);
+        m_rings.emplace_back(new ThreadRing());
+        p_ring = m_rings.back().get();
+        p_ring->tid = (int)m_rings.size() - 1;
+        p_ring->slots.reset(new RingSlot[PROFILE_SAMPLES_DEFAULT]);
+        p_ring->count = 0;
+    }
+    return p_ring;
+}
+
+void Profiler::setEnabled(bool new_enabled) {
+    m_enabled = new_enabled;
+}
+
+void Profiler::beginFrame() {
+    m_frame++;
+}
+
+int Profiler::getFrame() const {
+    return m_frame;
+}
+
+void Profiler::record(const char *name, std::int64_t start_ns, std::int64_t end_ns) {
+    ThreadRing *p_ring = threadRing();
+    std::uint64_t n = p_ring->count.load(std::memory_order_relaxed);
+    // Release stores: a reader that sees any of them also sees count n
+    // (getSamples() relies on this to spot a slot being rewritten)
+    RingSlot &slot = p_ring->slots[n % PROFILE_SAMPLES_DEFAULT];
+    slot.name.store(name, std::memory_order_release);
+    slot.start_ns.store(start_ns, std::memory_order_release);
+    slot.end_ns.store(end_ns, std::memory_order_release);
+    slot.frame.store(m_frame.load(std::memory_order_relaxed), std::memory_order_release);
+    p_ring->count.store(n + 1, std::memory_order_release);
+}
+
+std::vector<ProfileSample> Profiler::getSamples(int frames) {
+    int first_frame = m_frame - frames + 1;
+    std::vector<ProfileSample> out;
+    std::lock_guard<std::mutex> lock(m_rings_mutex);
+    const std::uint64_t size = PROFILE_SAMPLES_DEFAULT;
+    std::vector<ProfileSample> copied;
+    for (auto &p_ring : m_rings) {
+        // Sample n is written into the oldest slot, so that slot is skipped
+        std::uint64_t n = p_ring->count.load(std::memory_order_acquire);
+        std::uint64_t oldest = (n >= size) ? n - size + 1 : 0;
+        copied.clear();
+        for (std::uint64_t i = oldest; i < n; i++) {
+            const RingSlot &slot = p_ring->slots[i % size];
+            ProfileSample sample;
+            sample.name = slot.name.load(std::memory_order_acquire);
+            sample.start_ns = slot.start_ns.load(std::memory_order_acquire);
+            sample.end_ns = slot.end_ns.load(std::memory_order_acquire);
+            sample.frame = slot.frame.load(std::memory_order_acquire);
+            sample.tid = p_ring->tid;
+            copied.push_back(sample);
+        }
+
+        // Drop samples whose slots the owner may have rewritten while they
+        // were copied (up to sample now_n, which may be half written). The
+        // acquire loads above keep this count from being read before them.
+        std::uint64_t now_n = p_ring->count.load(std::memory_order_relaxed);
+        std::uint64_t first_valid = (now_n >= size) ? now_n - size + 1 : 0;
+        size_t skip = (size_t)std::min<std::uint64_t>(
+            first_valid > oldest ? first_valid - oldest : 0, copied.size());
+        for (size_t i = skip; i < copied.size(); i++) {
+            if (copied[i].frame >= first_frame) {
+                out.push_back(copied[i]);
+            }
+        }
+    }
+    return out;
+}
+
+// Regions become complete ("X") events; timestamps are microseconds.
+int Profiler::dumpTrace(const std::string &filename, int frames) {
+    std::vector<ProfileSample> samples = getSamples(frames);
+    std::FILE *p_f = std::fopen(filename.c_str(), "w");
+    if (p_f == nullptr) {
+        return -1;
+    }
+    std::fprintf(p_f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    for (size_t i = 0; i < samples.size(); i++) {
+        const ProfileSample &s = samples[i];
+        std::fprintf(p_f,
+                     "{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,"
+                     "\"pid\":0,\"tid\":%d,\"args\":{\"frame\":%d}}%s\n",
+                     s.name, s.start_ns / 1000.0, (s.end_ns - s.start_ns) / 1000.0,
+                     s.tid, s.frame, (i + 1 < samples.size()) ? "," : "");
+    }
+    std::fprintf(p_f, "]}\n");
+    return (std::fclose(p_f) == 0) ? 0 : -1;
+}
+
+} // end namespace df
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Samples each thread's ring holds (oldest are overwritten)
+const int PROFILE_SAMPLES_DEFAULT = 65536;
+
+// Frames dumpTrace() writes by default
+const int PROFILE_FRAMES_DEFAULT = 120;
+
+#define PROF df::Profiler::getInstance()
+
+// Scoped timers are compiled in only when DF_PROFILE is defined
+// (make PROFILE=1); otherwise they cost nothing.
+#ifdef DF_PROFILE
+#define DF_PROFILE_CONCAT_(a, b) a##b
+#define DF_PROFILE_CONCAT(a, b) DF_PROFILE_CONCAT_(a, b)
+// Time the rest of the enclosing scope as region name (a string literal)
+#define DF_PROFILE_SCOPE(name) \
+    df::ProfileScope DF_PROFILE_CONCAT(df_profile_scope_, __LINE__)(name)
+// Start a new frame
+#define DF_PROFILE_FRAME() PROF.beginFrame()
+#else
+#define DF_PROFILE_SCOPE(name) ((void)0)
+#define DF_PROFILE_FRAME() ((void)0)
+#endif
+
+namespace df {
+
+// One timed region
+struct ProfileSample {
+    const char *name;      // Region name (string literal)
+    std::int64_t start_ns; // Start (nanoseconds since profiler created)
+    std::int64_t end_ns;   // End (nanoseconds since profiler created)
+    int frame;             // Frame region ended in
+    int tid;               // Profiler's number for the recording thread
+};
+
+class Profiler {
+private:
+    // Slot of a thread's ring. Fields are atomic (release/acquire, plain
+    // moves on x86) because getSamples() may read a slot while its thread
+    // rewrites it; such reads are detected and dropped.
+    struct RingSlot {
+        std::atomic<const char *> name;
+        std::atomic<std::int64_t> start_ns;
+        std::atomic<std::int64_t> end_ns;
+        std::atomic<int> frame;
+    };
+
+    // Samples recorded by one thread, written only by that thread
+    struct ThreadRing {
+        int tid;                             // Thread number
+        std::unique_ptr<RingSlot[]> slots;   // Ring of PROFILE_SAMPLES_DEFAULT
+        std::atomic<std::uint64_t> count;    // Samples ever recorded
+    };
+
+    std::chrono::steady_clock::time_point m_start; // Time zero
+    std::atomic<bool> m_enabled;                   // True if recording
+    std::atomic<int> m_frame;                      // Current frame
+    std::mutex m_rings_mutex;                      // Guards m_rings
+    std::vector<std::unique_ptr<ThreadRing>> m_rings; // One per thread seen
+
+    Profiler();                            // Private (singleton)
+    Profiler(Profiler const &);            // No copy
+    void operator=(Profiler const &);      // No assign
+
+    // Return calling thread's ring, creating it on first use
+    ThreadRing *threadRing();
+
+public:
+    // Get the one and only instance of the Profiler
+    static Profiler &getInstance();
+
+    // Set whether regions are recorded (default true)
+    void setEnabled(bool new_enabled = true);
+
+    // Return true if regions are recorded
+    bool isEnabled() const {
+        return m_enabled.load(std::memory_order_relaxed);
+    }
+
+    // Start a new frame
+    void beginFrame();
+
+    // Get current frame number
+    int getFrame() const;
+
+    // Return nanoseconds since profiler was created
+    std::int64_t now() const {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - m_start).count();
+    }
+
+    // Record region name from start_ns to end_ns in calling thread's ring
+    void record(const char *name, std::int64_t start_ns, std::int64_t end_ns);
+
+    // Return samples from all threads recorded in the last frames frames
+    // (including the current one), oldest first per thread. Safe while
+    // other threads record: the slot a thread writes next, and any its
+    // owner overwrote during the copy, are left out.
+    std::vector<ProfileSample> getSamples(int frames = PROFILE_FRAMES_DEFAULT);
+
+    // Write the last frames frames as Chrome trace_event JSON (open in
+    // chrome://tracing or Perfetto).
+    // Return 0 if ok, else -1.
+    int dumpTrace(const std::string &filename, int frames = PROFILE_FRAMES_DEFAULT);
+};
+
+// Times the scope it lives in and records it when destroyed
+class ProfileScope {
+private:
+    const char *m_name;     // Region name
+    std::int64_t m_start;   // Start time, -1 if profiler was disabled
+
+public:
+    explicit ProfileScope(const char *name)
+        : m_name(name)
+        , m_start(PROF.isEnabled() ? PROF.now() : -1)
+    {}
+
+    ~ProfileScope() {
+        if (m_start >= 0) {
+            PROF.record(m_name, m_start, PROF.now());
+        }
+    }
+
+    ProfileScope(ProfileScope const &) = delete;
+    void operator=(ProfileScope const &) = delete;
+};
+
+} // end namespace df
@@ -3,12 +3,53 @@
 #include "DisplayManager.h"
 #include "EventCollision.h"
 #include "EventOut.h"
+#include "GameManager.h"
 #include "Object.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+#include <vector>
 
 namespace df {
 
-WorldManager::WorldManager() {
+// Most moves one job plans
+static const int MOVE_JOB_CHUNK = 256;
+
+// Sorted boxes are compacted once more than 1 in this many are removed
+// (or when they change anyway)
+static const int SWEEP_REMOVED_RATIO = 8;
+
+// Insertion sort gives up after this many shifts per entry (boxes that
+// jumped far, e.g. many setPosition() calls) and sorts from scratch
+static const int SWEEP_SHIFTS_RATIO = 4;
+
+WorldManager::WorldManager()
+    : m_p_deleting(nullptr)
+    , m_plan_count(0)
+    , m_is_resolving(false)
+    , m_swept(false)
+    , m_boundary(Vector(), (float)DM.getHorizontal(), (float)DM.getVertical())
+    , m_view(m_boundary)
+    , m_p_view_following(nullptr)
+    , m_is_drawing(false)
+{
     setType("WorldManager");
+    sweepClear(m_dests);
+    sweepClear(m_sweep_awake);
+    sweepClear(m_sweep_asleep);
+    m_dests.index = nullptr;
+    m_sweep_awake.index = &Object::m_sweep_index;
+    m_sweep_asleep.index = &Object::m_sweep_index;
+    for (int altitude = 0; altitude <= MAX_ALTITUDE; altitude++) {
+        sweepClear(m_sweep_visible_awake[altitude]);
+        sweepClear(m_sweep_visible_asleep[altitude]);
+        m_sweep_visible_awake[altitude].index = &Object::m_visible_index;
+        m_sweep_visible_asleep[altitude].index = &Object::m_visible_index;
+    }
+    m_updates.reserve(OBJECT_LIST_RESERVE_DEFAULT);
+    m_movers.reserve(OBJECT_LIST_RESERVE_DEFAULT);
+    m_outs.reserve(OBJECT_LIST_RESERVE_DEFAULT);
 }
 
 WorldManager &WorldManager::getInstance() {
@@ -16,133 +57,799 @@ WorldManager &WorldManager::getInstance() {
     return instance;
 }
 
+// Type buckets are emptied but kept, so cached getTypeList() pointers
+// survive a restart.
 int WorldManager::startUp() {
     m_updates.clear();
     m_deletions.clear();
-    LM.writeLog("WorldManager::startUp() - OK");
+    sweepClear(m_sweep_awake);
+    sweepClear(m_sweep_asleep);
+    for (auto &bucket : m_types) {
+        bucket.second.clear();
+    }
+    for (int altitude = 0; altitude <= MAX_ALTITUDE; altitude++) {
+        sweepClear(m_sweep_visible_awake[altitude]);
+        sweepClear(m_sweep_visible_asleep[altitude]);
+    }
+    m_drawn_in_view.clear();
+    m_boundary = Box(Vector(), (float)DM.getHorizontal(), (float)DM.getVertical());
+    m_view = m_boundary;
+    m_p_view_following = nullptr;
+    DF_LOG_INFO("WorldManager::startUp() - OK");
     return Manager::startUp();
 }
 
 void WorldManager::shutDown() {
-    // Delete all objects
-    ObjectList all = m_updates;
-    for (int i = 0; i < all.getCount(); i++) {
-        delete all[i];
+    // Delete all objects (each removes itself from the back of the list)
+    while (!m_updates.isEmpty()) {
+        delete m_updates[m_updates.getCount() - 1];
     }
     m_updates.clear();
     m_deletions.clear();
+    sweepClear(m_sweep_awake);
+    sweepClear(m_sweep_asleep);
+    for (auto &bucket : m_types) {
+        bucket.second.clear();
+    }
+    for (int altitude = 0; altitude <= MAX_ALTITUDE; altitude++) {
+        sweepClear(m_sweep_visible_awake[altitude]);
+        sweepClear(m_sweep_visible_asleep[altitude]);
+    }
+    m_drawn_in_view.clear();
     Manager::shutDown();
-    LM.writeLog("WorldManager::shutDown() - OK");
+    DF_LOG_INFO("WorldManager::shutDown() - OK");
+}
+
+WorldManager::SweepList &WorldManager::sweepListOf(const Object *p_o) {
+    return p_o->isAwake() ? m_sweep_awake : m_sweep_asleep;
+}
+
+WorldManager::SweepList &WorldManager::visibleListOf(const Object *p_o) {
+    int altitude = p_o->getAltitude();
+    return p_o->isAwake() ? m_sweep_visible_awake[altitude]
+                          : m_sweep_visible_asleep[altitude];
+}
+
+void WorldManager::sweepClear(SweepList &list) {
+    list.entries.clear();
+    list.sorted = 0;
+    list.removed = 0;
+    list.changed = false;
+    list.widest = 0;
+    list.tallest = 0;
+}
+
+// New entries go at the end and sort into place when next sorted.
+void WorldManager::sweepInsert(SweepList &list, Object *p_o) {
+    p_o->*list.index = (int)list.entries.size();
+    list.entries.push_back(SweepEntry{0, 0, 0, 0, p_o, 0, -1});
+    onBoxChange(p_o);
+}
+
+// Removed entries are only cleared here, so removing is O(1); the next
+// sweepSort() drops them. A cleared entry keeps its box, so the order is
+// unchanged and a few can wait (queries skip them): Objects waking one by
+// one don't make the asleep boxes re-sort every update.
+void WorldManager::sweepRemove(SweepList &list, Object *p_o) {
+    if (p_o->*list.index < 0) return;
+    list.entries[p_o->*list.index].p_o = nullptr;
+    p_o->*list.index = -1;
+    list.removed++;
+    if (list.removed * SWEEP_REMOVED_RATIO > (int)list.entries.size()) {
+        list.changed = true;
+    }
+}
+
+void WorldManager::sweepSet(SweepList &list, int index, const Box &box) {
+    list.changed = true;
+    SweepEntry &entry = list.entries[index];
+    entry.left = box.getCorner().getX();
+    entry.right = entry.left + box.getHorizontal();
+    entry.top = box.getCorner().getY();
+    entry.bottom = entry.top + box.getVertical();
+}
+
+// Order of entries: by left edge, then top edge.
+static bool sweepBefore(float left_a, float top_a, float left_b, float top_b) {
+    return left_a < left_b || (left_a == left_b && top_a < top_b);
+}
+
+// Entries sorted last time are nearly in order, so they are insertion
+// sorted; entries added since are sorted on their own and merged in.
+// If the old entries turn out far from order, insertion sort stops and
+// they are sorted with std::sort instead. Objects' indexes are only
+// rewritten for entries that move, unless entries were dropped, merged in
+// or sorted from scratch.
+void WorldManager::sweepSort(SweepList &list) {
+    if (!list.changed) return;
+    std::vector<SweepEntry> &entries = list.entries;
+    bool reindex = false;
+    if (list.removed > 0) {
+        int out = 0;
+        int sorted = 0;
+        for (int i = 0; i < (int)entries.size(); i++) {
+            if (entries[i].p_o == nullptr) continue;
+            if (i < list.sorted) sorted++;
+            entries[out++] = entries[i];
+        }
+        entries.resize(out);
+        list.sorted = sorted;
+        list.removed = 0;
+        reindex = true;
+    }
+    auto before = [](const SweepEntry &a, const SweepEntry &b) {
+        return sweepBefore(a.left, a.top, b.left, b.top);
+    };
+    long shifts_left = (long)list.sorted * SWEEP_SHIFTS_RATIO;
+    for (int i = 1; i < list.sorted; i++) {
+        SweepEntry entry = entries[i];
+        int j = i;
+        while (j > 0 && before(entry, entries[j - 1])) {
+            entries[j] = entries[j - 1];
+            entries[j].p_o->*list.index = j;
+            j--;
+        }
+        if (j != i) {
+            entries[j] = entry;
+            entry.p_o->*list.index = j;
+            shifts_left -= i - j;
+            if (shifts_left < 0) {
+                std::sort(entries.begin(), entries.begin() + list.sorted, before);
+                reindex = true;
+                break;
+            }
+        }
+    }
+    if (list.sorted < (int)entries.size()) {
+        std::sort(entries.begin() + list.sorted, entries.end(), before);
+        std::inplace_merge(entries.begin(), entries.begin() + list.sorted, entries.end(),
+                           before);
+        list.sorted = (int)entries.size();
+        reindex = true;
+    }
+
+    if (reindex) {
+        for (int i = 0; i < (int)entries.size(); i++) {
+            entries[i].p_o->*list.index = i;
+        }
+    }
+    sweepIndex(list);
+    list.changed = false;
+}
+
+void WorldManager::sweepIndex(SweepList &list) {
+    std::vector<SweepEntry> &entries = list.entries;
+    list.widest = 0;
+    list.tallest = 0;
+    int next_column = (int)entries.size();
+    for (int i = (int)entries.size() - 1; i >= 0; i--) {
+        SweepEntry &entry = entries[i];
+        if (i + 1 < (int)entries.size() && entries[i + 1].left != entry.left) {
+            next_column = i + 1;
+        }
+        entry.next_column = next_column;
+        list.widest = std::max(list.widest, entry.right - entry.left);
+        list.tallest = std::max(list.tallest, entry.bottom - entry.top);
+    }
+}
+
+// Entries starting widest or more left of region (or tallest or more
+// above it) can't reach it. The first of the rest is found by galloping
+// (1, 2, 4, ... entries) from hint, then binary search, so the cost grows
+// with the log of the distance from the hint and the entries read stay
+// nearby. Entries with the same left edge (Objects in one column) are
+// sorted by top edge, so each column is entered at the first entry that
+// may reach region (by binary search) and left once past its bottom.
+void WorldManager::sweepQuery(const SweepList &list, const Box &region, int hint,
+                              const Object *p_skip, std::vector<Object *> &out) {
+    const std::vector<SweepEntry> &entries = list.entries;
+    float left = region.getCorner().getX();
+    float right = left + region.getHorizontal();
+    float top = region.getCorner().getY();
+    float bottom = top + region.getVertical();
+    float reach = left - list.widest;
+    int count = (int)entries.size();
+    int low = std::min(std::max(hint, 0), count); // Entries before low can't reach
+    int high = low;                               // Entries from high on may
+    int step = 1;
+    if (low < count && entries[low].left <= reach) {
+        low++;
+        high = low;
+        while (high < count && entries[high].left <= reach) {
+            low = high + 1;
+            high = std::min(high + step, count);
+            step *= 2;
+        }
+    } else {
+        while (low > 0 && entries[low - 1].left > reach) {
+            high = low - 1;
+            low = std::max(low - 1 - step, 0);
+            step *= 2;
+        }
+    }
+    auto it = std::lower_bound(entries.begin() + low, entries.begin() + high, reach,
+                               [](const SweepEntry &e, float x) { return e.left <= x; });
+    while (it != entries.end() && it->left < right) {
+        auto column_end = entries.begin() + it->next_column;
+        it = std::lower_bound(it, column_end, top - list.tallest,
+                              [](const SweepEntry &e, float y) { return e.top <= y; });
+        for (; it != column_end && it->top < bottom; ++it) {
+            if (it->p_o == nullptr || it->p_o == p_skip) continue;
+            if (it->right > left && it->bottom > top) {
+                out.push_back(it->p_o);
+            }
+        }
+        it = column_end;
+    }
 }
 
 int WorldManager::insertObject(Object *p_o) {
+    if (p_o->isSolid()) {
+        sweepInsert(sweepListOf(p_o), p_o);
+    }
+    m_types[p_o->getType()].insert(p_o);
+    if (p_o->isVisible()) {
+        onVisibilityChange(p_o);
+    }
     return m_updates.insert(p_o);
 }
 
+// A marked Object deleted directly (not by update()) is also dropped from
+// the deletion lists so it isn't deleted twice. An Object deleted by an
+// event handler during update() is noted so the moves still to be made
+// skip it, and dropped from the out-of-bounds list. One deleted while
+// draw() draws is skipped by it.
 int WorldManager::removeObject(Object *p_o) {
+    if (p_o == m_p_view_following) {
+        m_p_view_following = nullptr;
+    }
+    if (p_o == m_p_deleting) {
+        return 0; // already removed by deleteMarked()
+    }
+    if (m_is_resolving) {
+        m_gone.insert(p_o);
+    }
+    if (!m_outs.isEmpty()) {
+        m_outs.remove(p_o);
+    }
+    if (p_o->isMarkedForDelete()) {
+        m_deletions.remove(p_o);
+        m_purging.remove(p_o);
+    }
+    sweepRemove(sweepListOf(p_o), p_o);
+    auto it = m_types.find(p_o->getType());
+    if (it != m_types.end()) {
+        it->second.remove(p_o);
+    }
+    if (m_is_drawing) {
+        std::replace(m_drawing.begin(), m_drawing.end(), p_o, (Object *)nullptr);
+    }
+    sweepRemove(visibleListOf(p_o), p_o);
+    if (p_o->isDrawnInView()) {
+        m_drawn_in_view.remove(p_o);
+    }
     return m_updates.remove(p_o);
 }
 
-ObjectList WorldManager::getAllObjects() const {
-    return m_updates;
+void WorldManager::onTypeChange(Object *p_o, const std::string &old_type) {
+    if (old_type == p_o->getType()) return;
+    auto it = m_types.find(old_type);
+    if (it != m_types.end()) {
+        it->second.remove(p_o);
+    }
+    m_types[p_o->getType()].insert(p_o);
+}
+
+void WorldManager::onSolidnessChange(Object *p_o, bool was_solid) {
+    if (was_solid == p_o->isSolid()) return;
+    if (was_solid) {
+        sweepRemove(sweepListOf(p_o), p_o);
+    } else {
+        sweepInsert(sweepListOf(p_o), p_o);
+    }
 }
 
-ObjectList WorldManager::objectsOfType(std::string type) const {
-    ObjectList list;
-    for (int i = 0; i < m_updates.getCount(); i++) {
-        if (m_updates[i]->getType() == type) {
-            list.insert(m_updates[i]);
+// Solid Objects don't move in parallel steps, so their boxes are set
+// right away. Awake visible Objects are marked moved, as integrate() marks
+// them, and draw() sets their boxes; asleep ones aren't stepped.
+void WorldManager::onBoxChange(Object *p_o) {
+    if (p_o->m_sweep_index >= 0) {
+        sweepSet(sweepListOf(p_o), p_o->m_sweep_index, p_o->getWorldBox());
+    }
+    if (p_o->m_visible_index >= 0) {
+        if (p_o->isAwake()) {
+            m_motion.markMoved(p_o->m_motion_index);
+        } else {
+            updateVisibleBox(p_o);
         }
     }
-    return list;
 }
 
-int WorldManager::markForDelete(Object *p_o) {
-    // Avoid duplicate marks
-    for (int i = 0; i < m_deletions.getCount(); i++) {
-        if (m_deletions[i] == p_o) {
-            return 0; // already marked
+// An Object is drawn between its previous and current positions if it
+// moved this step (getDrawPosition()), so its visible box covers both.
+void WorldManager::updateVisibleBox(Object *p_o) {
+    Box box = p_o->getWorldBox();
+    int index = p_o->m_motion_index;
+    if (m_motion.getPreviousStep(index) == GM.getStepCount()) {
+        Box prev_box = p_o->getWorldBox(m_motion.getPrevious(index));
+        float left = std::min(box.getCorner().getX(), prev_box.getCorner().getX());
+        float top = std::min(box.getCorner().getY(), prev_box.getCorner().getY());
+        float right = std::max(box.getCorner().getX() + box.getHorizontal(),
+                               prev_box.getCorner().getX() + prev_box.getHorizontal());
+        float bottom = std::max(box.getCorner().getY() + box.getVertical(),
+                                prev_box.getCorner().getY() + prev_box.getVertical());
+        box = Box(Vector(left, top), right - left, bottom - top);
+    }
+    sweepSet(visibleListOf(p_o), p_o->m_visible_index, box);
+}
+
+// Re-inserting the visible box also brings it up to date, as an Object
+// that moved may go to sleep before draw() sees it moved.
+void WorldManager::onAwakeChange(Object *p_o) {
+    m_motion.setAwake(p_o->m_motion_index, p_o->isAwake());
+    bool solid = p_o->m_sweep_index >= 0;
+    bool visible = p_o->m_visible_index >= 0;
+    sweepRemove(p_o->isAwake() ? m_sweep_asleep : m_sweep_awake, p_o);
+    sweepRemove(p_o->isAwake() ? m_sweep_visible_asleep[p_o->getAltitude()]
+                               : m_sweep_visible_awake[p_o->getAltitude()], p_o);
+    if (solid) sweepInsert(sweepListOf(p_o), p_o);
+    if (visible) sweepInsert(visibleListOf(p_o), p_o);
+}
+
+void WorldManager::onAltitudeChange(Object *p_o, int old_altitude) {
+    if (p_o->m_visible_index < 0 || old_altitude == p_o->getAltitude()) return;
+    sweepRemove(p_o->isAwake() ? m_sweep_visible_awake[old_altitude]
+                               : m_sweep_visible_asleep[old_altitude], p_o);
+    sweepInsert(visibleListOf(p_o), p_o);
+}
+
+// Objects drawn in view stay put on screen as the view moves, so they
+// are kept out of the visible boxes (which are in world spaces).
+void WorldManager::onVisibilityChange(Object *p_o) {
+    sweepRemove(visibleListOf(p_o), p_o);
+    m_drawn_in_view.remove(p_o);
+    if (!p_o->isVisible()) {
+        if (m_is_drawing) {
+            std::replace(m_drawing.begin(), m_drawing.end(), p_o, (Object *)nullptr);
         }
+    } else if (p_o->isDrawnInView()) {
+        m_drawn_in_view.insert(p_o);
+    } else {
+        sweepInsert(visibleListOf(p_o), p_o);
+    }
+}
+
+MotionStore &WorldManager::getMotion() {
+    return m_motion;
+}
+
+const ObjectList &WorldManager::getAllObjects() const {
+    return m_updates;
+}
+
+ObjectListView WorldManager::getAllObjectsView() {
+    return ObjectListView(m_updates);
+}
+
+const ObjectList &WorldManager::objectsOfType(const std::string &type) const {
+    static const ObjectList empty;
+    auto it = m_types.find(type);
+    if (it == m_types.end()) {
+        return empty;
     }
+    return it->second;
+}
+
+ObjectListView WorldManager::objectsOfTypeView(const std::string &type) {
+    return ObjectListView(m_types[type]);
+}
+
+const ObjectList *WorldManager::getTypeList(const std::string &type) {
+    return &m_types[type];
+}
+
+int WorldManager::markForDelete(Object *p_o) {
+    if (p_o == nullptr) return -1;
+    if (p_o->m_is_marked) return 0; // already marked
+    p_o->m_is_marked = true;
     return m_deletions.insert(p_o);
 }
 
-// Move a single object, checking collisions and out-of-bounds.
-static void moveObject(Object *p_o, Vector new_pos) {
-    // Check collisions with all other solid objects
-    if (p_o->isSolid()) {
-        ObjectList all = WM.getAllObjects();
-        for (int i = 0; i < all.getCount(); i++) {
-            Object *p_temp = all[i];
-            if (p_temp == p_o) continue;
-            if (!p_temp->isSolid()) continue;
+// Moves are planned from positions at the start of the update, so each
+// plan reads only the sorted boxes and its own Object and the work splits
+// across threads. A candidate is anything that may be in the way when the
+// mover's turn comes: solid Objects whose boxes overlap the area the move
+// covers now, and movers whose areas overlap it. A swept move can stop
+// anywhere along its path, so its whole area counts, not just its
+// destination box.
+void WorldManager::planMoves() {
+    sweepSort(m_sweep_awake);
+    sweepSort(m_sweep_asleep);
+    m_movers.clear();
+    m_motion.collectSolidMovers(m_movers);
+    m_plan_count = (int)m_movers.size();
+    if ((int)m_plans.size() < m_plan_count) {
+        m_plans.resize(m_plan_count);
+    }
+    m_move_order.resize(m_plan_count);
+    m_dests.entries.resize(m_plan_count);
+
+    GM.getJobs().parallelFor(m_plan_count, MOVE_JOB_CHUNK, [this](int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            MovePlan &plan = m_plans[i];
+            plan.p_o = m_movers[i];
+            plan.id = plan.p_o->getId();
+            plan.new_pos = plan.p_o->predictPosition();
+            planPath(plan, plan.p_o->getPosition());
+            m_move_order[i] = std::make_pair(plan.id, i);
+            float left = plan.region.getCorner().getX();
+            float top = plan.region.getCorner().getY();
+            m_dests.entries[i] = SweepEntry{left, left + plan.region.getHorizontal(),
+                                            top, top + plan.region.getVertical(),
+                                            plan.p_o, 0, i};
+            plan.candidates.clear();
+            sweepQuery(m_sweep_awake, plan.region, plan.p_o->m_sweep_index, plan.p_o,
+                       plan.candidates);
+            sweepQuery(m_sweep_asleep, plan.region, 0, plan.p_o, plan.candidates);
+        }
+    });
+    std::sort(m_move_order.begin(), m_move_order.end());
+    std::vector<SweepEntry> &dests = m_dests.entries;
+    std::sort(dests.begin(), dests.end(), [](const SweepEntry &a, const SweepEntry &b) {
+        return sweepBefore(a.left, a.top, b.left, b.top);
+    });
+    sweepIndex(m_dests);
+
+    // Movers whose areas overlap are candidates for each other: sweep
+    // each area against those sorted after it (the rest of its column
+    // starts below its top, so needs no search)
+    for (int a = 0; a < m_plan_count; a++) {
+        const SweepEntry &dest = dests[a];
+        auto column = dests.begin() + a + 1;
+        while (column != dests.end() && column->left < dest.right) {
+            auto column_end = dests.begin() + column->next_column;
+            auto it = column;
+            if (column->left != dest.left) {
+                it = std::lower_bound(column, column_end, dest.top - m_dests.tallest,
+                                      [](const SweepEntry &e, float y) { return e.top <= y; });
+            }
+            for (; it != column_end && it->top < dest.bottom; ++it) {
+                if (it->right > dest.left && it->bottom > dest.top) {
+                    m_plans[dest.plan].candidates.push_back(it->p_o);
+                    m_plans[it->plan].candidates.push_back(dest.p_o);
+                }
+            }
+            column = column_end;
+        }
+    }
+
+    // Order candidates
+    GM.getJobs().parallelFor(m_plan_count, MOVE_JOB_CHUNK, [this](int begin, int end) {
+        for (int i = begin; i < end; i++) {
+            std::vector<Object *> &candidates = m_plans[i].candidates;
+            if (candidates.size() < 2) continue;
+            std::sort(candidates.begin(), candidates.end(), [](const Object *p_a, const Object *p_b) {
+                return p_a->getId() < p_b->getId();
+            });
+            candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+        }
+    });
+}
+
+// Grid DDA: step from cell to cell along the move, always across the
+// nearer cell boundary, recording where each cell is entered. A blocked
+// move stops just short of the boundary, in the cell before.
+void WorldManager::planPath(MovePlan &plan, Vector from) const {
+    plan.path.clear();
+    Box dest = plan.p_o->getWorldBox(plan.new_pos);
+    float x0 = from.getX(), y0 = from.getY();
+    int cx = (int)std::floor(x0), cy = (int)std::floor(y0);
+    int end_x = (int)std::floor(plan.new_pos.getX());
+    int end_y = (int)std::floor(plan.new_pos.getY());
+    if (!m_swept || (cx == end_x && cy == end_y)) {
+        plan.path.push_back(PathCell{plan.new_pos, plan.new_pos, from});
+        plan.region = dest;
+        return;
+    }
 
-            // Simple point collision check
-            if (static_cast<int>(new_pos.getX()) == static_cast<int>(p_temp->getPosition().getX()) &&
-                static_cast<int>(new_pos.getY()) == static_cast<int>(p_temp->getPosition().getY())) {
+    const float inf = std::numeric_limits<float>::infinity();
+    float dx = plan.new_pos.getX() - x0, dy = plan.new_pos.getY() - y0;
+    int step_x = (dx > 0) ? 1 : (dx < 0) ? -1 : 0;
+    int step_y = (dy > 0) ? 1 : (dy < 0) ? -1 : 0;
+    float t_max_x = (dx > 0) ? ((float)(cx + 1) - x0) / dx : (dx < 0) ? ((float)cx - x0) / dx : inf;
+    float t_max_y = (dy > 0) ? ((float)(cy + 1) - y0) / dy : (dy < 0) ? ((float)cy - y0) / dy : inf;
+    float t_delta_x = (dx != 0) ? 1.0f / std::fabs(dx) : inf;
+    float t_delta_y = (dy != 0) ? 1.0f / std::fabs(dy) : inf;
+
+    while ((cx != end_x || cy != end_y) && (int)plan.path.size() < SWEEP_CELLS_MAX) {
+        float t;
+        Vector contact, stop;
+        if (t_max_x < t_max_y) {
+            t = t_max_x;
+            t_max_x += t_delta_x;
+            float boundary = (float)((step_x > 0) ? cx + 1 : cx);
+            cx += step_x;
+            contact = Vector(boundary, y0 + dy * t);
+            stop = Vector((step_x > 0) ? std::nextafter(boundary, -inf) : boundary, contact.getY());
+        } else {
+            t = t_max_y;
+            t_max_y += t_delta_y;
+            float boundary = (float)((step_y > 0) ? cy + 1 : cy);
+            cy += step_y;
+            contact = Vector(x0 + dx * t, boundary);
+            stop = Vector(contact.getX(), (step_y > 0) ? std::nextafter(boundary, -inf) : boundary);
+        }
+        if (t > 1.0f) break;
+        plan.path.push_back(PathCell{Vector((float)cx, (float)cy), contact, stop});
+    }
+    if (cx != end_x || cy != end_y) {
+        plan.path.push_back(PathCell{plan.new_pos, plan.new_pos, from});
+    }
+    plan.region = plan.p_o->getWorldBox(from).merged(dest);
+}
+
+// Plans run in id order, and within a plan path cells in order and
+// candidates in id order, so the events and final positions don't depend
+// on list order or thread count. A candidate collides (once per move) if
+// it is still solid and its box overlaps the mover's box at the cell when
+// the mover's turn comes, as when Objects moved one at a time; it wakes
+// if asleep. A mover put to sleep before its turn stays put.
+void WorldManager::resolveMoves() {
+    m_is_resolving = true;
+    std::vector<Object *> hit;
+    for (int i = 0; i < m_plan_count; i++) {
+        MovePlan &plan = m_plans[m_move_order[i].second];
+        Object *p_o = plan.p_o;
+        if (isGone(p_o) || !p_o->isSolid() || !p_o->isAwake()) continue;
+
+        const PathCell *p_blocked = nullptr;
+        hit.clear();
+        for (const PathCell &path_cell : plan.path) {
+            if (plan.candidates.empty()) break;
+            Box box = p_o->getWorldBox(path_cell.at);
+            for (Object *p_temp : plan.candidates) {
+                if (isGone(p_temp) || !p_temp->isSolid() ||
+                    std::find(hit.begin(), hit.end(), p_temp) != hit.end() ||
+                    !box.intersects(p_temp->getWorldBox())) {
+                    continue;
+                }
+                hit.push_back(p_temp);
+                p_temp->setAwake(true);
 
                 // Send collision event to both objects
-                EventCollision ec(p_o, p_temp, new_pos);
+                EventCollision ec(p_o, p_temp, path_cell.contact);
                 p_o->eventHandler(&ec);
-                p_temp->eventHandler(&ec);
+                if (!isGone(p_temp)) p_temp->eventHandler(&ec);
+                if (isGone(p_o)) break;
 
                 // HARD objects block movement
-                if (p_o->getSolidness() == HARD && p_temp->getSolidness() == HARD) {
-                    return; // don't move
+                if (p_o->getSolidness() == HARD && !isGone(p_temp) &&
+                    p_temp->getSolidness() == HARD) {
+                    p_blocked = &path_cell;
+                    break;
                 }
             }
+            if (p_blocked != nullptr || isGone(p_o)) break;
+        }
+        if (isGone(p_o)) continue;
+
+        // Move object (up to the blocker, if swept)
+        Vector new_pos = plan.new_pos;
+        if (p_blocked != nullptr) {
+            if (!m_swept) continue;
+            new_pos = p_blocked->stop;
+            if (new_pos == p_o->getPosition()) continue;
+        }
+        p_o->setPosition(new_pos);
+
+        // Check out of bounds
+        if (isOutside(new_pos)) {
+            EventOut eo;
+            p_o->eventHandler(&eo);
         }
     }
+    m_is_resolving = false;
+    m_gone.clear();
+}
+
+bool WorldManager::isGone(Object *p_o) const {
+    return !m_gone.empty() && m_gone.count(p_o) > 0;
+}
+
+bool WorldManager::isOutside(Vector pos) const {
+    Vector corner = m_boundary.getCorner();
+    return pos.getX() < corner.getX() ||
+           pos.getX() >= corner.getX() + m_boundary.getHorizontal() ||
+           pos.getY() < corner.getY() ||
+           pos.getY() >= corner.getY() + m_boundary.getVertical();
+}
 
-    // Move object
-    p_o->setPosition(new_pos);
+// Solid Objects can be stopped by collisions, so they move in two phases
+// against the sorted boxes. Everything else has nothing to hit and is
+// integrated straight in the MotionStore arrays; those Objects get their
+// out-of-bounds events after the whole batch has moved.
+void WorldManager::update() {
+    // Move solid objects by velocity
+    planMoves();
+    resolveMoves();
 
-    // Check out of bounds
-    int h = WM.getHorizontal();
-    int v = WM.getVertical();
-    float x = new_pos.getX();
-    float y = new_pos.getY();
-    if (x < 0 || x >= h || y < 0 || y >= v) {
+    // Move all other objects by velocity
+    int step = GM.isStepping() ? GM.getStepCount() : -1;
+    m_motion.integrate(step, m_boundary, m_outs);
+    for (Object *p_o : ObjectListView(m_outs)) {
         EventOut eo;
         p_o->eventHandler(&eo);
     }
+    m_outs.clear();
+
+    // Delete objects marked for deletion
+    if (!m_deletions.isEmpty()) {
+        deleteMarked();
+    }
 }
 
-void WorldManager::update() {
-    // Move all objects by velocity
-    for (int i = 0; i < m_updates.getCount(); i++) {
-        Object *p_o = m_updates[i];
-        Vector vel = p_o->getVelocity();
-        if (vel.getX() != 0.0f || vel.getY() != 0.0f) {
-            Vector new_pos = p_o->predictPosition();
-            moveObject(p_o, new_pos);
+// Marked Objects are taken out of the sorted boxes one by one (O(1) each),
+// and out of the update, type and interest lists they are
+// in with one compaction pass per list. Their destructors then skip the
+// per-list removes. Objects marked while this runs wait for next update().
+void WorldManager::deleteMarked() {
+    std::swap(m_purging, m_deletions);
+    m_deletions.clear();
+
+    std::vector<ObjectList *> type_lists;
+    std::vector<std::pair<Manager *, int>> interests;
+    for (Object *p_o : ObjectListView(m_purging)) {
+        sweepRemove(sweepListOf(p_o), p_o);
+        sweepRemove(visibleListOf(p_o), p_o);
+        if (p_o->isDrawnInView()) {
+            m_drawn_in_view.remove(p_o);
+        }
+        ObjectList *p_list = &m_types[p_o->getType()];
+        if (std::find(type_lists.begin(), type_lists.end(), p_list) == type_lists.end()) {
+            type_lists.push_back(p_list);
+        }
+        for (int event_id : p_o->m_interests) {
+            std::pair<Manager *, int> interest(&Object::interestManager(event_id), event_id);
+            if (std::find(interests.begin(), interests.end(), interest) == interests.end()) {
+                interests.push_back(interest);
+            }
         }
     }
 
-    // Delete objects marked for deletion
-    for (int i = 0; i < m_deletions.getCount(); i++) {
-        delete m_deletions[i];
+    m_updates.removeMarked();
+    for (ObjectList *p_list : type_lists) {
+        p_list->removeMarked();
     }
-    m_deletions.clear();
+    for (const std::pair<Manager *, int> &interest : interests) {
+        interest.first->removeMarkedInterests(interest.second);
+    }
+
+    // View: a destructor may delete another marked Object directly
+    for (Object *p_o : ObjectListView(m_purging)) {
+        p_o->m_interests.clear();
+        m_p_deleting = p_o;
+        delete p_o;
+    }
+    m_p_deleting = nullptr;
+    m_purging.clear();
 }
 
+// Objects whose visible boxes overlap the view are found in the sorted
+// boxes of each altitude, so off-view and hidden Objects cost nothing and
+// no sort by altitude is needed. Those found that moved this step are
+// tested again where they are drawn (interpolated), as their visible
+// boxes cover the whole step's move. Objects at one altitude are drawn
+// awake ones first, each in sorted box order, then those drawn in view,
+// which are tested against the view's size instead. Awake Objects that
+// moved (by integrate() or setPosition()) have their visible boxes
+// brought up to date here, once per frame.
 void WorldManager::draw() {
+    if (m_p_view_following != nullptr) {
+        setViewPosition(m_p_view_following->getDrawPosition());
+    }
+    m_drawing.clear();
+    m_motion.takeMoved(m_drawing);
+    for (Object *p_o : m_drawing) {
+        if (p_o->m_visible_index >= 0) updateVisibleBox(p_o);
+    }
+
     // Draw objects in altitude order (lowest first)
-    for (int alt = 0; alt <= MAX_ALTITUDE; alt++) {
-        for (int i = 0; i < m_updates.getCount(); i++) {
-            if (m_updates[i]->getAltitude() == alt) {
-                m_updates[i]->draw();
+    m_drawing.clear();
+    Box screen(Vector(), m_view.getHorizontal(), m_view.getVertical());
+    for (int altitude = 0; altitude <= MAX_ALTITUDE; altitude++) {
+        sweepSort(m_sweep_visible_awake[altitude]);
+        sweepSort(m_sweep_visible_asleep[altitude]);
+        sweepQuery(m_sweep_visible_awake[altitude], m_view, 0, nullptr, m_drawing);
+        sweepQuery(m_sweep_visible_asleep[altitude], m_view, 0, nullptr, m_drawing);
+        for (int i = 0; i < m_drawn_in_view.getCount(); i++) {
+            Object *p_o = m_drawn_in_view[i];
+            if (p_o->getAltitude() == altitude &&
+                p_o->getWorldBox(p_o->getDrawPosition()).intersects(screen)) {
+                m_drawing.push_back(p_o);
             }
         }
     }
+
+    // Culled in a pass of its own: the Objects' loads don't wait on each
+    // other's draw(), so they overlap
+    int step = GM.getStepCount();
+    for (Object *&p_o : m_drawing) {
+        if (!p_o->m_is_drawn_in_view &&
+            m_motion.getPreviousStep(p_o->m_motion_index) == step &&
+            !p_o->getWorldBox(p_o->getDrawPosition()).intersects(m_view)) {
+            p_o = nullptr;
+        }
+    }
+    m_is_drawing = true;
+    for (int i = 0; i < (int)m_drawing.size(); i++) {
+        Object *p_o = m_drawing[i];
+        if (p_o != nullptr) p_o->draw();
+    }
+    m_is_drawing = false;
+}
+
+void WorldManager::setSweptCollisions(bool new_swept) {
+    m_swept = new_swept;
+}
+
+bool WorldManager::isSweptCollisions() const {
+    return m_swept;
 }
 
 int WorldManager::getHorizontal() const {
-    return DM.getHorizontal();
+    return (int)m_boundary.getHorizontal();
 }
 
 int WorldManager::getVertical() const {
-    return DM.getVertical();
+    return (int)m_boundary.getVertical();
+}
+
+void WorldManager::setBoundary(Box new_boundary) {
+    m_boundary = new_boundary;
+}
+
+Box WorldManager::getBoundary() const {
+    return m_boundary;
+}
+
+void WorldManager::setView(Box new_view) {
+    m_view = new_view;
+}
+
+Box WorldManager::getView() const {
+    return m_view;
+}
+
+// Each axis is clamped to the boundary's far edge first, then its near
+// edge, so a view bigger than the boundary sits at the boundary corner.
+void WorldManager::setViewPosition(Vector view_pos) {
+    Vector corner = m_boundary.getCorner();
+    float x = std::floor(view_pos.getX() - m_view.getHorizontal() / 2);
+    x = std::min(x, corner.getX() + m_boundary.getHorizontal() - m_view.getHorizontal());
+    x = std::max(x, corner.getX());
+    float y = std::floor(view_pos.getY() - m_view.getVertical() / 2);
+    y = std::min(y, corner.getY() + m_boundary.getVertical() - m_view.getVertical());
+    y = std::max(y, corner.getY());
+    m_view.setCorner(Vector(x, y));
+}
+
+void WorldManager::setViewFollowing(Object *p_new_view_following) {
+    m_p_view_following = p_new_view_following;
+    if (m_p_view_following != nullptr) {
+        setViewPosition(m_p_view_following->getPosition());
+    }
+}
+
+Object *WorldManager::getViewFollowing() const {
+    return m_p_view_following;
+}
+
+Vector WorldManager::worldToView(Vector world_pos) const {
+    return world_pos - m_view.getCorner();
+}
+
+Vector WorldManager::viewToWorld(Vector view_pos) const {
+    return view_pos + m_view.getCorner();
 }
 
 } // end namespace df
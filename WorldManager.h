@@ -1,21 +1,169 @@
 #pragma once
 
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 #include "Manager.h"
+#include "MotionStore.h"
 #include "ObjectList.h"
+#include "ObjectListView.h"
+#include "Box.h"
+#include "Object.h"
+#include "Vector.h"
 
 #define WM df::WorldManager::getInstance()
 
+// Most cells a swept move checks (the rest of a longer path is skipped)
+const int SWEEP_CELLS_MAX = 256;
+
 namespace df {
 
 class WorldManager : public Manager {
 private:
+    // World box of a solid or visible Object (or area of a move), kept
+    // sorted by left edge, then top edge, for sort-and-sweep
+    struct SweepEntry {
+        float left, right;   // Horizontal extent
+        float top, bottom;   // Vertical extent
+        Object *p_o;         // Object (nullptr once removed)
+        int next_column;     // Index of first entry with a greater left edge
+        int plan;            // Index of move's plan (move areas only)
+    };
+
+    // Boxes sorted by left edge, then top edge
+    struct SweepList {
+        std::vector<SweepEntry> entries;
+        int sorted;          // Entries in sorted order as of last sort
+        int removed;         // Removed entries not yet dropped
+        bool changed;        // True if any entry added, removed or moved since
+        float widest;        // Widest box
+        float tallest;       // Tallest box
+        int Object::*index;  // Objects' field holding their entry's index
+    };
+
+    // Cell on a move's path
+    struct PathCell {
+        Vector at;           // Position the box is tested at
+        Vector contact;      // Where the move enters the cell
+        Vector stop;         // Where the move ends if blocked in the cell
+    };
+
+    // Move of one solid Object, worked out before any Object moves
+    struct MovePlan {
+        Object *p_o;                     // Object moving
+        int id;                          // Its id (resolution order)
+        Vector new_pos;                  // Position after the move
+        Box region;                      // Area the move's boxes cover
+        std::vector<PathCell> path;      // Cells checked, in path order
+        std::vector<Object *> candidates; // Solid Objects that may be in
+                                          // the way when it moves, by id
+    };
+
     ObjectList m_updates;       // All active game objects
     ObjectList m_deletions;     // Objects marked for deletion
+    ObjectList m_purging;       // Marked Objects being deleted by update()
+    Object *m_p_deleting;       // Object update() is deleting right now
+    MotionStore m_motion;       // Position and velocity of every Object
+    std::vector<Object *> m_movers;  // Solid Objects update() is moving
+    std::vector<MovePlan> m_plans;   // Their moves (reused between updates)
+    int m_plan_count;                // Moves in use in m_plans
+    std::vector<std::pair<int, int>> m_move_order; // (id, plan index) by id
+    SweepList m_dests;               // Areas of moves (where they may end)
+    bool m_is_resolving;             // True while solid moves are resolved
+    bool m_swept;                    // True if moves check every cell crossed
+    std::unordered_set<Object *> m_gone; // Objects deleted while resolving
+    ObjectList m_outs;          // Objects update() moved out of bounds
+    Box m_boundary;             // World extent (spaces)
+    Box m_view;                 // Part of world shown in window (spaces)
+    Object *m_p_view_following; // Object view is centered on (or nullptr)
+
+    // Objects bucketed by type. Buckets are never erased, so pointers
+    // handed out by getTypeList() stay valid.
+    std::unordered_map<std::string, ObjectList> m_types;
+
+    // Boxes of awake and asleep visible Objects at each altitude, covering
+    // where they may be drawn, so draw() finds the ones in view without
+    // testing the rest, already in drawing order. Asleep Objects don't
+    // move, so theirs rarely need re-sorting.
+    SweepList m_sweep_visible_awake[MAX_ALTITUDE + 1];
+    SweepList m_sweep_visible_asleep[MAX_ALTITUDE + 1];
+    ObjectList m_drawn_in_view;      // Visible Objects placed in view spaces
+    std::vector<Object *> m_drawing; // Objects draw() is drawing
+    bool m_is_drawing;               // True while draw() draws them
+
+    // Boxes of awake and asleep solid Objects. Each list is re-sorted by
+    // insertion sort when it has changed, which is near linear as Objects
+    // move little between updates (new entries wait at the end until
+    // then). Asleep Objects don't move, so theirs rarely needs it.
+    SweepList m_sweep_awake;
+    SweepList m_sweep_asleep;
 
     WorldManager();                             // Private (singleton)
     WorldManager(WorldManager const &);         // No copy
     void operator=(WorldManager const &);       // No assign
 
+    // Return sorted boxes solid Object's box belongs in (by whether it is
+    // awake)
+    SweepList &sweepListOf(const Object *p_o);
+
+    // Return sorted boxes visible Object's box belongs in (by altitude and
+    // whether it is awake)
+    SweepList &visibleListOf(const Object *p_o);
+
+    // Set visible Object's box to cover where it may be drawn this frame
+    void updateVisibleBox(Object *p_o);
+
+    // Empty sorted boxes
+    static void sweepClear(SweepList &list);
+
+    // Add Object to sorted boxes
+    void sweepInsert(SweepList &list, Object *p_o);
+
+    // Remove Object from sorted boxes
+    static void sweepRemove(SweepList &list, Object *p_o);
+
+    // Set box of entry (the list needs sorting again)
+    static void sweepSet(SweepList &list, int index, const Box &box);
+
+    // Drop removed entries and re-sort, if changed since last sort
+    static void sweepSort(SweepList &list);
+
+    // Set next_column of sorted entries and find their widest and
+    // tallest boxes
+    static void sweepIndex(SweepList &list);
+
+    // Append Objects of sorted entries whose boxes overlap region, except
+    // p_skip. Search starts from entry hint, which should be near region.
+    static void sweepQuery(const SweepList &list, const Box &region, int hint,
+                           const Object *p_skip, std::vector<Object *> &out);
+
+    // Plan moves of all solid Objects with velocity: path and collision
+    // candidates, in parallel on GM's job threads
+    void planMoves();
+
+    // Set the cells plan checks and the region they cover: the
+    // destination cell, or (if swept and the move leaves its cell) every
+    // cell the move crosses
+    void planPath(MovePlan &plan, Vector from) const;
+
+    // Carry out planned moves in id order: send collision events, stop
+    // HARD Objects blocked by HARD ones, move the rest, send
+    // out-of-bounds events
+    void resolveMoves();
+
+    // Return true if Object was deleted while moves are being resolved
+    bool isGone(Object *p_o) const;
+
+    // Return true if position is outside world boundary
+    bool isOutside(Vector pos) const;
+
+    // Delete every Object marked for delete, removing them from each
+    // list they are in with one pass per list
+    void deleteMarked();
+
 public:
     // Get the one and only instance of the WorldManager
     static WorldManager &getInstance();
@@ -35,31 +183,119 @@ public:
     // Return 0 if ok, else -1
     int removeObject(Object *p_o);
 
-    // Return list of all Objects in world
-    ObjectList getAllObjects() const;
+    // Add/remove Object to/from the solid boxes when it changes solidness
+    // (called by Object::setSolidness)
+    void onSolidnessChange(Object *p_o, bool was_solid);
+
+    // Keep solid and visible boxes current when an Object moves or
+    // changes box (called by Object::setPosition, setBox and setShape).
+    // An awake Object's visible box waits for draw(), so thread-safe steps
+    // can move their Objects in parallel.
+    void onBoxChange(Object *p_o);
+
+    // Move Object between the awake and asleep motion slots and solid
+    // boxes (called by Object::setAwake)
+    void onAwakeChange(Object *p_o);
+
+    // Move Object to the bucket for its new type
+    // (called by Object::setType)
+    void onTypeChange(Object *p_o, const std::string &old_type);
+
+    // Move Object to the visible boxes for its new altitude
+    // (called by Object::setAltitude)
+    void onAltitudeChange(Object *p_o, int old_altitude);
+
+    // Move Object among visible boxes and Objects drawn in view when it is
+    // shown, hidden or placed in view (called by Object::setVisible and
+    // setDrawnInView)
+    void onVisibilityChange(Object *p_o);
+
+    // Return position and velocity storage of all Objects
+    MotionStore &getMotion();
+
+    // Return list of all Objects in world (no copy)
+    const ObjectList &getAllObjects() const;
+
+    // Return view for iterating all Objects without copying the list.
+    // Objects deleted during iteration are skipped, new ones are not visited.
+    ObjectListView getAllObjectsView();
 
-    // Return list of Objects matching given type
-    ObjectList objectsOfType(std::string type) const;
+    // Return list of Objects matching given type (no scan, no copy)
+    const ObjectList &objectsOfType(const std::string &type) const;
 
-    // Mark Object for deferred deletion
+    // Return view for iterating Objects of given type without copying
+    // the list (as getAllObjectsView())
+    ObjectListView objectsOfTypeView(const std::string &type);
+
+    // Return stable pointer to the list of Objects of given type, creating
+    // an empty list if the type is new. Hot code can cache the pointer to
+    // skip the string lookup; it stays valid for the life of the program.
+    const ObjectList *getTypeList(const std::string &type);
+
+    // Mark Object for deletion at the end of update() (marking twice is
+    // harmless)
     // Return 0 if ok, else -1
     int markForDelete(Object *p_o);
 
-    // Update game world:
-    //   - Move objects by velocity
-    //   - Detect and send collision events
-    //   - Send out-of-bounds events
+    // Update game world (asleep objects are skipped, so cost grows with
+    // the number of awake ones):
+    //   - Plan moves of solid objects from their positions and velocities
+    //     at the start of the update, in parallel
+    //   - Carry them out in Object id order, sending collision (waking
+    //     asleep objects hit) and out-of-bounds events (same results for
+    //     any job thread count)
+    //   - Move all other objects by velocity in one SIMD pass, then send
+    //     their out-of-bounds events
     //   - Delete marked objects
     void update();
 
-    // Draw all Objects (ordered by altitude)
+    // Draw visible Objects whose boxes (where they are drawn) overlap the
+    // view, ordered by altitude. The rest are culled before draw() is
+    // called, so an Object drawing outside its box should set a box
+    // that covers what it draws.
     void draw();
 
+    // Set swept collisions: moves check every cell between the old and
+    // new positions (not just the new one), stop at the first HARD
+    // blocker and report where they hit it, so fast Objects can't pass
+    // through thin walls (default false)
+    void setSweptCollisions(bool new_swept = true);
+
+    // Return true if collisions are swept
+    bool isSweptCollisions() const;
+
     // Horizontal boundary (in spaces)
     int getHorizontal() const;
 
     // Vertical boundary (in spaces)
     int getVertical() const;
+
+    // Set/get world boundary: Objects leaving it get out-of-bounds events
+    // (defaults to window size, reset by startUp())
+    void setBoundary(Box new_boundary);
+    Box getBoundary() const;
+
+    // Set/get view: the part of the world drawn in the window (defaults
+    // to window size, reset by startUp())
+    void setView(Box new_view);
+    Box getView() const;
+
+    // Center view on position, keeping it inside the boundary where it
+    // fits. The view's corner is kept on whole spaces, so the world
+    // scrolls a cell at a time.
+    void setViewPosition(Vector view_pos);
+
+    // Set Object the view stays centered on each draw() (nullptr to
+    // stop); the view moves to it now. Following stops when the Object
+    // is deleted.
+    void setViewFollowing(Object *p_new_view_following);
+
+    // Return Object the view is following (nullptr if none)
+    Object *getViewFollowing() const;
+
+    // Convert world position to view (window) position, and back
+    Vector worldToView(Vector world_pos) const;
+    Vector viewToWorld(Vector view_pos) const;
 };
 
 } // end namespace df
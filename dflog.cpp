@@ -0,0 +1,34 @@
+// =============================================================================
+// dflog - decode a binary Dragonfly log into text
+// Usage:
+//   ./dflog [file]     (default dragonfly.dflog; "-" reads stdin)
+// Prints the same "[HH:MM:SS] LEVEL message" lines a text log would hold.
+// =============================================================================
+
+#include <iostream>
+#include <fstream>
+#include <string>
+
+#include "LogManager.h"
+#include "LogRecord.h"
+
+int main(int argc, char *argv[]) {
+    std::string path = (argc > 1) ? argv[1] : LOGFILE_BINARY_DEFAULT;
+
+    std::ifstream file;
+    std::istream *p_in = &std::cin;
+    if (path != "-") {
+        file.open(path, std::ifstream::in | std::ifstream::binary);
+        if (!file.is_open()) {
+            std::cerr << "dflog: cannot open '" << path << "'\n";
+            return 1;
+        }
+        p_in = &file;
+    }
+
+    if (df::decodeLogBinary(*p_in, std::cout) != 0) {
+        std::cerr << "dflog: '" << path << "' is not a binary log, or is truncated\n";
+        return 1;
+    }
+    return 0;
+}
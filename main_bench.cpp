@@ -0,0 +1,631 @@
+// =============================================================================
+// Dragonfly Game Engine - Benchmarks
+// Times engine hot paths at increasing object counts. Build with
+// optimization for meaningful numbers, e.g.:
+//   make bench CXXFLAGS="-std=c++17 -O2 -pthread"
+// =============================================================================
+
+#include <iostream>
+#include <iomanip>
+#include <cstdlib>
+#include <cmath>
+#include <fstream>
+#include <vector>
+#include <algorithm>
+#include <thread>
+
+#include <SFML/Graphics.hpp>
+
+#include "LogManager.h"
+#include "WorldManager.h"
+#include "DisplayManager.h"
+#include "GameManager.h"
+#include "EventStep.h"
+#include "PoolAllocator.h"
+#include "Clock.h"
+#include "Vector.h"
+#include "Object.h"
+
+// -----------------------------------------------------------------------
+// Bench helpers
+// -----------------------------------------------------------------------
+static float randomFloat(float lo, float hi) {
+    return lo + (hi - lo) * ((float)std::rand() / (float)RAND_MAX);
+}
+
+static void printRow(const char *label, int n, long int total_us, int frames) {
+    double us_per_frame = (double)total_us / frames;
+    double ns_per_object = us_per_frame * 1000.0 / n;
+    std::cout << "  " << std::left << std::setw(24) << label
+              << std::right << std::setw(8) << n << " objects  "
+              << std::fixed << std::setprecision(1)
+              << std::setw(10) << us_per_frame << " us/frame  "
+              << std::setw(8) << ns_per_object << " ns/object\n";
+}
+
+// -----------------------------------------------------------------------
+// WORLD UPDATE (movement + collision) BENCH
+// Objects are spread at constant density, so a broadphase that scales
+// with local neighbours should keep ns/object roughly flat.
+// -----------------------------------------------------------------------
+void benchWorldUpdate() {
+    std::cout << "\n--- WorldManager::update (movement + collision) ---\n";
+
+    const int counts[] = {100, 1000, 10000, 50000};
+    const int frames = 30;
+
+    for (int n : counts) {
+        WM.startUp();
+        float side = std::sqrt((float)n * 8.0f); // ~8 cells per object
+        for (int i = 0; i < n; i++) {
+            df::Object *p_o = new df::Object();
+            p_o->setPosition(df::Vector(randomFloat(0, side), randomFloat(0, side)));
+            if (i % 2 == 0) {
+                p_o->setVelocity(df::Vector(randomFloat(-1, 1), randomFloat(-1, 1)));
+            }
+        }
+
+        df::Clock clock;
+        for (int f = 0; f < frames; f++) {
+            WM.update();
+        }
+        printRow("update", n, clock.delta(), frames);
+        WM.setSweptCollisions(true);
+        clock.delta();
+        for (int f = 0; f < frames; f++) {
+            WM.update();
+        }
+        printRow("update (swept)", n, clock.delta(), frames);
+        WM.setSweptCollisions(false);
+        // Every Object jumps somewhere else before each update
+        df::ObjectList all = WM.getAllObjects();
+        long int jump_time = 0;
+        for (int f = 0; f < frames; f++) {
+            for (int i = 0; i < all.getCount(); i++) {
+                all[i]->setPosition(df::Vector(randomFloat(0, side), randomFloat(0, side)));
+            }
+            clock.delta();
+            WM.update();
+            jump_time += clock.delta();
+        }
+        printRow("update (all jump)", n, jump_time, frames);
+        WM.shutDown();
+    }
+}
+
+// -----------------------------------------------------------------------
+// MOVEMENT INTEGRATION BENCH
+// Non-solid movers (particles, effects) are integrated in one SIMD pass
+// over MotionStore, so ns/object should stay well under the solid path.
+// -----------------------------------------------------------------------
+void benchIntegrate() {
+    std::cout << "\n--- WorldManager::update (non-solid movers) ---\n";
+
+    const int counts[] = {1000, 10000, 100000};
+    const int frames = 100;
+
+    for (int n : counts) {
+        WM.startUp();
+        for (int i = 0; i < n; i++) {
+            df::Object *p_o = new df::Object();
+            p_o->setSolidness(df::SPECTRAL);
+            p_o->setPosition(df::Vector(randomFloat(0, 80), randomFloat(0, 24)));
+            p_o->setVelocity(df::Vector(randomFloat(-0.01f, 0.01f), randomFloat(-0.01f, 0.01f)));
+        }
+
+        df::Clock clock;
+        for (int f = 0; f < frames; f++) {
+            WM.update();
+        }
+        printRow("integrate", n, clock.delta(), frames);
+        WM.shutDown();
+    }
+}
+
+// -----------------------------------------------------------------------
+// SLEEPING OBJECTS BENCH
+// A world of resting Objects (scenery) with a few movers, with the
+// resting ones left awake vs put to sleep. Asleep Objects are skipped by
+// movement, so the update should cost little more than the movers'
+// collisions. Then whole frames (update and draw) with a fixed set of
+// visible movers and more and more asleep Objects: us/frame should stay
+// about the same, as per-frame work only visits awake Objects.
+// -----------------------------------------------------------------------
+static void benchSleepFrames() {
+    const int movers = 1000;
+    const int asleep_counts[] = {10000, 100000, 1000000};
+    const int frames = 30;
+    DM.setHeadless(true);
+    DM.startUp();
+    df::Box window = WM.getView();
+
+    for (int asleep : asleep_counts) {
+        int n = movers + asleep;
+        float side = std::sqrt((float)n * 8.0f);
+        WM.startUp();
+        WM.setBoundary(df::Box(df::Vector(), side, side));
+        WM.setView(window);
+        WM.setViewPosition(df::Vector(side / 2, side / 2));
+        for (int i = 0; i < n; i++) {
+            df::Object *p_o = new df::Object();
+            p_o->setSolidness(df::SPECTRAL);
+            p_o->setPosition(df::Vector(randomFloat(0, side), randomFloat(0, side)));
+            if (i < movers) {
+                p_o->setVelocity(df::Vector(randomFloat(-0.5f, 0.5f), randomFloat(-0.5f, 0.5f)));
+            } else {
+                p_o->setAwake(false);
+            }
+        }
+
+        WM.update();
+        WM.draw(); // first sort of all boxes
+        df::Clock clock;
+        for (int f = 0; f < frames; f++) {
+            WM.update();
+            WM.draw();
+            DM.swapBuffers();
+        }
+        printRow("frame (1000 awake)", n, clock.delta(), frames);
+        WM.shutDown();
+    }
+
+    DM.shutDown();
+    DM.setHeadless(false);
+}
+
+void benchSleep() {
+    std::cout << "\n--- WorldManager::update (few movers, mostly at rest) ---\n";
+
+    const int n = 50000;
+    const int movers = 500;
+    const int frames = 30;
+    float side = std::sqrt((float)n * 8.0f);
+
+    for (bool sleep : {false, true}) {
+        WM.startUp();
+        for (int i = 0; i < n; i++) {
+            df::Object *p_o = new df::Object();
+            p_o->setPosition(df::Vector(randomFloat(0, side), randomFloat(0, side)));
+            if (i < movers) {
+                p_o->setVelocity(df::Vector(randomFloat(-1, 1), randomFloat(-1, 1)));
+            } else if (sleep) {
+                p_o->setAwake(false);
+            }
+        }
+
+        WM.update(); // first sort of all boxes
+        df::Clock clock;
+        for (int f = 0; f < frames; f++) {
+            WM.update();
+        }
+        printRow(sleep ? "update (rest asleep)" : "update (rest awake)", n,
+                 clock.delta(), frames);
+        WM.shutDown();
+    }
+
+    benchSleepFrames();
+}
+
+// -----------------------------------------------------------------------
+// OBJECT CHURN BENCH
+// Short-lived objects (bullets) spawned every frame and marked for
+// delete after a fixed lifetime, with the default allocator vs the pool.
+// "raw" times only allocation and freeing in the same pattern.
+// -----------------------------------------------------------------------
+class PlainBullet : public df::Object {
+public:
+    PlainBullet() {
+        setSolidness(df::SPECTRAL);
+        setVelocity(df::Vector(1, 0));
+    }
+};
+
+class PooledBullet : public df::Object, public df::Pooled {
+public:
+    PooledBullet() {
+        setSolidness(df::SPECTRAL);
+        setVelocity(df::Vector(1, 0));
+    }
+};
+
+const int CHURN_FRAMES = 200;
+const int CHURN_SPAWN = 1000; // Objects spawned per frame
+const int CHURN_LIFE = 10;    // Frames each object lives
+
+template <class Bullet>
+static void benchChurnObjects(const char *label) {
+    WM.startUp();
+    std::vector<std::vector<df::Object *>> ages(CHURN_LIFE);
+    df::Clock clock;
+    for (int f = 0; f < CHURN_FRAMES; f++) {
+        std::vector<df::Object *> &oldest = ages[f % CHURN_LIFE];
+        for (df::Object *p_o : oldest) {
+            WM.markForDelete(p_o);
+        }
+        oldest.clear();
+        for (int i = 0; i < CHURN_SPAWN; i++) {
+            df::Object *p_o = new Bullet();
+            p_o->setPosition(df::Vector((float)(i % 80), (float)(i / 80)));
+            oldest.push_back(p_o);
+        }
+        WM.update();
+    }
+    long int us = clock.split();
+    std::cout << "  " << std::left << std::setw(20) << label << std::right
+              << std::fixed << std::setprecision(1)
+              << std::setw(10) << (double)us / CHURN_FRAMES << " us/frame  "
+              << std::setw(8) << us * 1000.0 / ((double)CHURN_FRAMES * CHURN_SPAWN)
+              << " ns/object\n";
+    WM.shutDown();
+}
+
+template <class Alloc, class Free>
+static void benchChurnRaw(const char *label, Alloc alloc, Free free_block) {
+    std::vector<std::vector<void *>> ages(CHURN_LIFE);
+    df::Clock clock;
+    for (int f = 0; f < CHURN_FRAMES; f++) {
+        std::vector<void *> &oldest = ages[f % CHURN_LIFE];
+        for (void *p : oldest) free_block(p);
+        oldest.clear();
+        for (int i = 0; i < CHURN_SPAWN; i++) oldest.push_back(alloc());
+    }
+    long int us = clock.split();
+    for (std::vector<void *> &age : ages) {
+        for (void *p : age) free_block(p);
+    }
+    std::cout << "  " << std::left << std::setw(20) << label << std::right
+              << std::fixed << std::setprecision(1)
+              << std::setw(10) << (double)us / CHURN_FRAMES << " us/frame  "
+              << std::setw(8) << us * 1000.0 / ((double)CHURN_FRAMES * CHURN_SPAWN)
+              << " ns/object\n";
+}
+
+void benchChurn() {
+    std::cout << "\n--- Object churn (" << CHURN_SPAWN << " spawned/frame, "
+              << CHURN_LIFE << "-frame life) ---\n";
+    const size_t size = sizeof(PooledBullet);
+    benchChurnRaw("raw heap", [=]() { return ::operator new(size); },
+                  [](void *p) { ::operator delete(p); });
+    benchChurnRaw("raw pool", [=]() { return df::poolAllocate(size); },
+                  [=](void *p) { df::poolDeallocate(p, size); });
+    benchChurnObjects<PlainBullet>("objects heap");
+    benchChurnObjects<PooledBullet>("objects pool");
+}
+
+// -----------------------------------------------------------------------
+// LOG BENCH
+// Text and binary log modes. "caller" is time spent in DF_LOG_INFO();
+// "end-to-end" also waits for the writer to write everything, so it shows
+// writer throughput (records queue with LOG_BLOCK, never dropped).
+// -----------------------------------------------------------------------
+static void benchLogMode(bool binary) {
+    const int n = 200000;
+    LM.setBinary(binary);
+    LM.startUp();
+    LM.setFullPolicy(df::LOG_BLOCK);
+
+    df::Clock clock;
+    for (int i = 0; i < n; i++) {
+        DF_LOG_INFO("Bench: object %d moved to (%.2f, %.2f) in %s", i,
+                    (double)i * 0.5, (double)i * 0.25, "bench");
+    }
+    long int caller_us = clock.split();
+    LM.drain();
+    long int total_us = clock.split();
+    LM.shutDown();
+    LM.setFullPolicy(df::LOG_DROP);
+    LM.setBinary(false);
+
+    std::ifstream f(binary ? LOGFILE_BINARY_DEFAULT : LOGFILE_DEFAULT,
+                    std::ifstream::binary | std::ifstream::ate);
+    double bytes = (double)f.tellg() / n;
+    std::cout << "  " << std::left << std::setw(8) << (binary ? "binary" : "text")
+              << std::right << std::fixed << std::setprecision(1)
+              << std::setw(8) << caller_us * 1000.0 / n << " ns/record caller  "
+              << std::setw(8) << total_us * 1000.0 / n << " ns/record end-to-end  "
+              << std::setw(6) << bytes << " bytes/record\n";
+}
+
+void benchLog() {
+    std::cout << "\n--- LogManager (" << 200000 << " records, 4 args) ---\n";
+    benchLogMode(false);
+    benchLogMode(true);
+}
+
+// -----------------------------------------------------------------------
+// PARALLEL STEP BENCH
+// Step event to objects with about a microsecond of thread-safe work
+// each, run through the game loop, by count of job threads.
+// -----------------------------------------------------------------------
+class BusyStepper : public df::Object {
+public:
+    float state;
+    BusyStepper(bool thread_safe) : state(randomFloat(1, 2)) {
+        setSolidness(df::SPECTRAL);
+        setVisible(false);
+        registerInterest(STEP_EVENT_ID);
+        setStepThreadSafe(thread_safe);
+    }
+    int eventHandler(const df::Event *p_e) override {
+        if (p_e->getTypeId() != STEP_EVENT_ID) return 0;
+        for (int i = 0; i < 100; i++) {
+            state = std::sqrt(state * state + 1.0f) - 0.5f;
+        }
+        return 1;
+    }
+};
+
+class StepCounter : public df::Object {
+public:
+    int remaining;
+    StepCounter(int steps) : remaining(steps) {
+        setSolidness(df::SPECTRAL);
+        registerInterest(STEP_EVENT_ID);
+    }
+    int eventHandler(const df::Event *p_e) override {
+        if (p_e->getTypeId() != STEP_EVENT_ID) return 0;
+        if (--remaining == 0) GM.setGameOver(true);
+        return 1;
+    }
+};
+
+void benchParallelStep() {
+    const int n = 20000;
+    const int steps = 50;
+    std::cout << "\n--- Step event (" << n << " objects, ~1 us each) ---\n";
+    int old_frame_time = GM.getFrameTime();
+    GM.setFrameTime(1); // step back to back
+
+    int cores = (int)std::thread::hardware_concurrency();
+    std::vector<int> worker_counts = {0, 1, 3, 7, 15};
+    for (int workers : worker_counts) {
+        if (workers >= cores) break;
+        WM.startUp();
+        GM.getJobs().startUp(workers);
+        for (int i = 0; i < n; i++) new BusyStepper(workers > 0);
+        new StepCounter(steps);
+        df::Clock clock;
+        GM.setGameOver(false);
+        GM.run();
+        long int us = clock.delta();
+        std::cout << "  " << std::setw(2) << workers << " job threads"
+                  << std::fixed << std::setprecision(1)
+                  << std::setw(10) << (double)us / steps << " us/step\n";
+        WM.shutDown();
+    }
+    GM.getJobs().shutDown();
+    GM.setFrameTime(old_frame_time);
+}
+
+// -----------------------------------------------------------------------
+// FRAME PACING BENCH
+// Step-to-step intervals of the game loop at 60 Hz, headless (no vsync).
+// Jitter is the standard deviation of the interval.
+// -----------------------------------------------------------------------
+class PaceRecorder : public df::Object {
+public:
+    int remaining;
+    df::Clock clock;
+    std::vector<long int> intervals;
+
+    PaceRecorder(int steps) : remaining(steps) {
+        setSolidness(df::SPECTRAL);
+        registerInterest(STEP_EVENT_ID);
+    }
+
+    int eventHandler(const df::Event *p_e) override {
+        if (p_e->getTypeId() != STEP_EVENT_ID) return 0;
+        intervals.push_back(clock.delta());
+        if (--remaining == 0) GM.setGameOver(true);
+        return 1;
+    }
+};
+
+static void benchPacingMode(const char *label, df::FramePacing pacing) {
+    const int steps = 120;
+    GM.setPacing(pacing);
+    PaceRecorder *p_r = new PaceRecorder(steps + 1);
+    GM.setGameOver(false);
+    GM.run();
+
+    // First interval is from construction, not a step
+    double sum = 0, sum_sq = 0;
+    std::vector<long int> offs;
+    for (size_t i = 1; i < p_r->intervals.size(); i++) {
+        long int t = p_r->intervals[i];
+        sum += t;
+        sum_sq += (double)t * t;
+        offs.push_back(std::labs(t - GM.getFrameTime()));
+    }
+    std::sort(offs.begin(), offs.end());
+    double mean = sum / steps;
+    double jitter = std::sqrt(sum_sq / steps - mean * mean);
+    std::cout << "  " << std::left << std::setw(8) << label
+              << std::right << std::fixed << std::setprecision(1)
+              << std::setw(10) << mean << " us/step  "
+              << std::setw(8) << jitter << " us jitter  "
+              << std::setw(6) << offs[offs.size() / 2] << " us median off  "
+              << std::setw(6) << offs.back() << " us worst\n";
+    delete p_r;
+}
+
+void benchPacing() {
+    std::cout << "\n--- Frame pacing (60 Hz, " << 120 << " steps) ---\n";
+    WM.startUp();
+    DM.setHeadless(true);
+    DM.startUp();
+    int old_frame_time = GM.getFrameTime();
+    GM.setFrameTime(16667);
+
+    benchPacingMode("sleep", df::PACE_SLEEP);
+    benchPacingMode("hybrid", df::PACE_HYBRID);
+
+    GM.setFrameTime(old_frame_time);
+    GM.setPacing(df::PACE_HYBRID);
+    DM.shutDown();
+    DM.setHeadless(false);
+    WM.shutDown();
+}
+
+// -----------------------------------------------------------------------
+// DRAW BENCH
+// A world much bigger than the window, drawn with the view the size of
+// the window ("view") and with the view covering the whole world ("all
+// in view", the cost without culling; drawCh still clips to the window).
+// Off-view Objects are not visited, so "view" should stay small.
+// -----------------------------------------------------------------------
+void benchDraw() {
+    std::cout << "\n--- WorldManager::draw (world larger than window) ---\n";
+
+    const int n = 50000;
+    const int frames = 30;
+    float side = std::sqrt((float)n * 8.0f);
+    WM.startUp();
+    DM.setHeadless(true);
+    DM.startUp();
+    df::Box window = WM.getView();
+    df::Box world(df::Vector(), side, side);
+    WM.setBoundary(world);
+    for (int i = 0; i < n; i++) {
+        df::Object *p_o = new df::Object();
+        p_o->setSolidness(df::SPECTRAL);
+        p_o->setShape("<=>");
+        p_o->setPosition(df::Vector(randomFloat(0, side), randomFloat(0, side)));
+    }
+
+    for (bool cull : {true, false}) {
+        WM.setView(cull ? window : world);
+        WM.setViewPosition(df::Vector(side / 2, side / 2));
+        df::Clock clock;
+        for (int f = 0; f < frames; f++) {
+            WM.draw();
+            DM.swapBuffers();
+        }
+        printRow(cull ? "draw (view)" : "draw (all in view)", n, clock.delta(), frames);
+    }
+
+    DM.shutDown();
+    DM.setHeadless(false);
+    WM.shutDown();
+}
+
+// -----------------------------------------------------------------------
+// GLYPH RENDERING BENCH
+// "immediate" reproduces the old per-character path (a RectangleShape and
+// a Text draw call per character); "batched" goes through DM.drawCh and
+// one draw call per frame in DM.swapBuffers, with every cell changing
+// each frame ("static": none changing). Both render offscreen into a
+// texture, so no window or display is needed (only an OpenGL context).
+// -----------------------------------------------------------------------
+static void printGlyphRate(const char *label, long int glyphs, long int us) {
+    std::cout << "  " << std::left << std::setw(24) << label << std::right
+              << std::fixed << std::setprecision(0)
+              << std::setw(12) << (double)glyphs * 1000000.0 / us << " glyphs/s\n";
+}
+
+void benchGlyphs() {
+    std::cout << "\n--- Glyph rendering (full screen per frame) ---\n";
+
+    DM.setOffscreen(true);
+    if (DM.startUp() != 0) {
+        std::cout << "  skipped: DisplayManager could not start (no OpenGL context?)\n";
+        DM.setOffscreen(false);
+        return;
+    }
+
+    const int frames = 60;
+    const int cols = DM.getHorizontal();
+    const int rows = DM.getVertical();
+    const long int glyphs = (long int)frames * cols * rows;
+    sf::RenderTexture target;
+    if (!target.resize({(unsigned int)DM.getHorizontalPixels(),
+                        (unsigned int)DM.getVerticalPixels()})) {
+        std::cout << "  skipped: could not create offscreen texture\n";
+        DM.shutDown();
+        DM.setOffscreen(false);
+        return;
+    }
+
+    // Immediate: two draw calls per character
+    sf::Font font;
+    if (font.openFromFile(FONT_FILE_DEFAULT)) {
+        sf::RectangleShape rectangle;
+        sf::Text text(font);
+        text.setStyle(sf::Text::Bold);
+        float w = DM.charWidth();
+        float h = DM.charHeight();
+        text.setCharacterSize((unsigned int)((w < h ? w : h) * 2));
+        rectangle.setSize(sf::Vector2f(w, h));
+        rectangle.setFillColor(sf::Color::Black);
+
+        df::Clock clock;
+        for (int f = 0; f < frames; f++) {
+            for (int y = 0; y < rows; y++) {
+                for (int x = 0; x < cols; x++) {
+                    df::Vector p = DM.spacesToPixels(df::Vector((float)x, (float)y));
+                    rectangle.setPosition({p.getX() - w / 10.0f, p.getY() + h / 5.0f});
+                    target.draw(rectangle);
+                    text.setString((char)('!' + (x + y + f) % 90));
+                    text.setFillColor(sf::Color::Green);
+                    text.setPosition({p.getX(), p.getY()});
+                    target.draw(text);
+                }
+            }
+            target.display();
+            target.clear();
+        }
+        printGlyphRate("immediate", glyphs, clock.delta());
+    }
+
+    // Batched: one draw call per frame
+    df::Clock clock;
+    for (int f = 0; f < frames; f++) {
+        for (int y = 0; y < rows; y++) {
+            for (int x = 0; x < cols; x++) {
+                DM.drawCh(df::Vector((float)x, (float)y),
+                          (char)('!' + (x + y + f) % 90), df::GREEN);
+            }
+        }
+        DM.swapBuffers();
+    }
+    printGlyphRate("batched", glyphs, clock.delta());
+
+    // Static screen: same picture every frame, no cells rebuilt
+    for (int f = 0; f < frames; f++) {
+        for (int y = 0; y < rows; y++) {
+            for (int x = 0; x < cols; x++) {
+                DM.drawCh(df::Vector((float)x, (float)y),
+                          (char)('!' + (x + y) % 90), df::GREEN);
+            }
+        }
+        DM.swapBuffers();
+    }
+    printGlyphRate("batched (static)", glyphs, clock.delta());
+
+    DM.shutDown();
+    DM.setOffscreen(false);
+}
+
+// -----------------------------------------------------------------------
+// MAIN
+// -----------------------------------------------------------------------
+int main() {
+    std::cout << "======================================\n";
+    std::cout << " Dragonfly Engine - Benchmarks\n";
+    std::cout << "======================================\n";
+
+    std::srand(1);
+
+    benchWorldUpdate();
+    benchIntegrate();
+    benchSleep();
+    benchChurn();
+    benchLog();
+    benchParallelStep();
+    benchPacing();
+    benchDraw();
+    benchGlyphs();
+
+    std::cout << "\n======================================\n";
+    return 0;
+}
@@ -5,24 +5,39 @@
 // =============================================================================
 
 #include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iterator>
+#include <vector>
+#include <cstdio>
+#include <cstdarg>
 #include <cassert>
 #include <cmath>
 #include <string>
 #include <thread>
+#include <atomic>
 #include <chrono>
 
 #include "LogManager.h"
+#include "LogRecord.h"
 #include "GameManager.h"
+#include "Profiler.h"
+#include "PoolAllocator.h"
 #include "WorldManager.h"
 #include "DisplayManager.h"
+#include "InputManager.h"
 #include "Clock.h"
 #include "Vector.h"
+#include "Box.h"
 #include "Object.h"
 #include "ObjectList.h"
+#include "ObjectListView.h"
 #include "Event.h"
 #include "EventStep.h"
 #include "EventOut.h"
 #include "EventCollision.h"
+#include "EventKeyboard.h"
+#include "EventMouse.h"
 
 // -----------------------------------------------------------------------
 // Test helpers
@@ -53,18 +68,48 @@ public:
     int collision_count  = 0;
     int out_count        = 0;
     std::string last_event;
+    df::Vector last_collision; // Position of last collision event
 
-    TestObject() { setType("TestObject"); }
+    TestObject() {
+        setType("TestObject");
+        registerInterest(STEP_EVENT);
+    }
 
     int eventHandler(const df::Event *p_e) override {
         last_event = p_e->getType();
         if (p_e->getType() == STEP_EVENT)     { step_count++;      return 1; }
-        if (p_e->getType() == COLLISION_EVENT){ collision_count++; return 1; }
+        if (p_e->getType() == COLLISION_EVENT){
+            collision_count++;
+            last_collision = static_cast<const df::EventCollision *>(p_e)->getPosition();
+            return 1;
+        }
         if (p_e->getType() == OUT_EVENT)      { out_count++;       return 1; }
         return 0;
     }
 };
 
+// Same as TestObject, but registers and checks events by type id
+class IdTestObject : public df::Object {
+public:
+    int step_count       = 0;
+    int collision_count  = 0;
+    int out_count        = 0;
+
+    IdTestObject() {
+        setType("IdTestObject");
+        registerInterest(STEP_EVENT_ID);
+    }
+
+    int eventHandler(const df::Event *p_e) override {
+        switch (p_e->getTypeId()) {
+        case STEP_EVENT_ID:      step_count++;      return 1;
+        case COLLISION_EVENT_ID: collision_count++; return 1;
+        case OUT_EVENT_ID:       out_count++;       return 1;
+        default:                 return 0;
+        }
+    }
+};
+
 // -----------------------------------------------------------------------
 // VECTOR TESTS
 // -----------------------------------------------------------------------
@@ -189,6 +234,75 @@ void testObjectList() {
     // Remove non-existent returns -1
     ASSERT_EQ(raw.remove(dummy1), -1, "Remove nonexistent returns -1");
 
+    // No fixed cap: list grows past the old 1000-slot limit
+    df::ObjectList big;
+    big.reserve(1500);
+    for (int i = 0; i < 1500; i++) {
+        big.insert(reinterpret_cast<df::Object *>(0x2000 + i));
+    }
+    ASSERT_EQ(big.getCount(), 1500, "List holds 1500 objects");
+    ASSERT_TRUE(!big.isFull(), "List never reports full");
+
+    // Remove swaps last element into the hole
+    big.remove(reinterpret_cast<df::Object *>(0x2000));
+    ASSERT_EQ(big.getCount(), 1499, "Count after remove from big list");
+    ASSERT_EQ(big[0], reinterpret_cast<df::Object *>(0x2000 + 1499),
+              "Remove moves last element into freed slot");
+    ASSERT_EQ(big.remove(reinterpret_cast<df::Object *>(0x2000 + 1499)), 0,
+              "Moved element is found at its new slot");
+    ASSERT_EQ(big[0], reinterpret_cast<df::Object *>(0x2000 + 1498),
+              "Removing moved element swaps in the new last");
+    ASSERT_EQ(big.insert(reinterpret_cast<df::Object *>(0x2000 + 1)), -1,
+              "Object already in list is not inserted again");
+    ASSERT_EQ(big.getCount(), 1498, "Count after repeated insert");
+    int found = 0;
+    for (int i = 0; i < 1500; i += 3) {
+        big.remove(reinterpret_cast<df::Object *>(0x2000 + i));
+    }
+    for (int i = 0; i < 1500; i++) {
+        if (big.remove(reinterpret_cast<df::Object *>(0x2000 + i)) == 0) found++;
+    }
+    ASSERT_EQ(found, 999, "Every remaining object found after many removes");
+    ASSERT_TRUE(big.isEmpty(), "List empty after removing all");
+
+    // View skips objects removed mid-iteration and ignores new inserts
+    df::ObjectList viewed;
+    viewed.insert(dummy1);
+    viewed.insert(dummy2);
+    viewed.insert(dummy3);
+    int visited = 0;
+    bool saw_removed = false;
+    for (df::Object *p_o : df::ObjectListView(viewed)) {
+        if (p_o == dummy1) {
+            viewed.remove(dummy2);
+            viewed.insert(reinterpret_cast<df::Object *>(0x1004));
+        }
+        if (p_o == dummy2) saw_removed = true;
+        visited++;
+    }
+    ASSERT_EQ(visited, 2, "View visits only objects live at start");
+    ASSERT_TRUE(!saw_removed, "View skips object removed during iteration");
+    ASSERT_EQ(viewed.getCount(), 3, "Holes compacted when view ends");
+    ASSERT_EQ(viewed[1], dummy3, "Compaction keeps order of remaining objects");
+
+    // Index loops under a live view see no holes
+    for (df::Object *p_o : df::ObjectListView(viewed)) {
+        if (p_o != dummy1) continue;
+        viewed.remove(dummy1);
+        ASSERT_EQ(viewed.getCount(), 2, "Hole not counted under a view");
+        bool no_holes = true;
+        for (int i = 0; i < viewed.getCount(); i++) {
+            if (viewed[i] == nullptr) no_holes = false;
+        }
+        ASSERT_TRUE(no_holes, "Indexing skips holes under a view");
+        ASSERT_EQ(viewed[0], dummy3, "Index past a hole finds next object");
+        viewed.remove(dummy3);
+        viewed.insert(dummy2);
+        ASSERT_EQ(viewed.getCount(), 2, "Count after remove and insert under a view");
+        ASSERT_TRUE(viewed[0] == reinterpret_cast<df::Object *>(0x1004) && viewed[1] == dummy2,
+                    "Indexing follows removes and inserts under a view");
+    }
+
     LM.writeLog("ObjectList tests complete.");
 }
 
@@ -221,9 +335,27 @@ void testEvents() {
     // EventCollision
     df::EventCollision ec;
     ASSERT_EQ(ec.getType(), COLLISION_EVENT, "EventCollision default type");
+    ASSERT_EQ(ec.getTypeId(), (int)COLLISION_EVENT_ID, "EventCollision type id");
     ASSERT_TRUE(ec.getObject1() == nullptr, "EventCollision default obj1 nullptr");
     ASSERT_TRUE(ec.getObject2() == nullptr, "EventCollision default obj2 nullptr");
 
+    // Interned type ids
+    ASSERT_EQ(e.getTypeId(), df::Event::registerType("my_event"),
+              "setType interns name to registered id");
+    ASSERT_TRUE(e.getTypeId() >= FIRST_USER_EVENT_ID, "User event id after built-ins");
+    ASSERT_EQ(df::Event::registerType(STEP_EVENT), (int)STEP_EVENT_ID,
+              "Built-in name maps to fixed id");
+    ASSERT_EQ(df::Event::typeName(STEP_EVENT_ID), STEP_EVENT, "typeName(STEP_EVENT_ID)");
+    ASSERT_EQ(df::Event::typeName(COLLISION_EVENT_ID), COLLISION_EVENT,
+              "typeName(COLLISION_EVENT_ID)");
+    ASSERT_EQ(df::Event::typeName(OUT_EVENT_ID), OUT_EVENT, "typeName(OUT_EVENT_ID)");
+    ASSERT_EQ(df::Event::typeName(KEYBOARD_EVENT_ID), KEYBOARD_EVENT,
+              "typeName(KEYBOARD_EVENT_ID)");
+    ASSERT_EQ(df::Event::typeName(MSE_EVENT_ID), MSE_EVENT, "typeName(MSE_EVENT_ID)");
+    df::EventKeyboard ek;
+    ASSERT_EQ(ek.getTypeId(), (int)KEYBOARD_EVENT_ID, "EventKeyboard type id");
+    ASSERT_EQ(df::Event::typeName(-5), UNDEFINED_EVENT, "typeName of unknown id");
+
     LM.writeLog("Event tests complete.");
 }
 
@@ -293,6 +425,119 @@ void testObject() {
     LM.writeLog("Object tests complete.");
 }
 
+// -----------------------------------------------------------------------
+// BATCH DELETION TESTS
+// -----------------------------------------------------------------------
+static int doomed_deleted = 0;
+static int doomed_steps = 0;
+
+class Doomed : public df::Object {
+public:
+    Doomed *p_partner = nullptr; // Deleted along with this one if set
+    Doomed() {
+        setType("Doomed");
+        registerInterest(STEP_EVENT_ID);
+    }
+    ~Doomed() override {
+        doomed_deleted++;
+        delete p_partner;
+    }
+    int eventHandler(const df::Event *p_e) override {
+        if (p_e->getTypeId() != STEP_EVENT_ID) return 0;
+        doomed_steps++;
+        return 1;
+    }
+};
+
+void testBatchDelete() {
+    int before = WM.getAllObjects().getCount();
+    const int n = 200;
+    std::vector<Doomed *> doomed;
+    for (int i = 0; i < n; i++) {
+        Doomed *p_d = new Doomed();
+        p_d->setPosition(df::Vector((float)(i % 20), (float)(i / 20)));
+        doomed.push_back(p_d);
+    }
+    df::Object *p_keep = new df::Object();
+    p_keep->registerInterest(STEP_EVENT_ID);
+
+    doomed_deleted = 0;
+    for (int i = 0; i < n; i += 2) {
+        WM.markForDelete(doomed[i]);
+        WM.markForDelete(doomed[i]); // second mark is a no-op
+    }
+    ASSERT_TRUE(doomed[0]->isMarkedForDelete() && !doomed[1]->isMarkedForDelete(),
+                "isMarkedForDelete reflects marks");
+
+    // Marked object deleted directly is not deleted again by update()
+    delete doomed[2];
+    // Destructor deleting another marked object
+    doomed[4]->p_partner = doomed[6];
+
+    WM.update();
+    ASSERT_EQ(doomed_deleted, n / 2, "Each marked object deleted exactly once");
+    ASSERT_EQ(WM.getAllObjects().getCount(), before + n / 2 + 1,
+              "Marked objects removed from update list");
+    ASSERT_EQ(WM.objectsOfType("Doomed").getCount(), n / 2,
+              "Marked objects removed from type bucket");
+    df::EventStep step(0);
+    doomed_steps = 0;
+    GM.onEvent(&step);
+    ASSERT_EQ(doomed_steps, n / 2, "Marked objects removed from step interests");
+
+    for (int i = 1; i < n; i += 2) {
+        delete doomed[i];
+    }
+    delete p_keep;
+    ASSERT_EQ(WM.getAllObjects().getCount(), before, "All batch objects gone");
+}
+
+void testMotionStore() {
+    int before = WM.getMotion().getCount();
+    const int n = 11; // two SIMD batches plus a scalar tail
+    std::vector<TestObject *> movers;
+    for (int i = 0; i < n; i++) {
+        TestObject *p_t = new TestObject();
+        p_t->setSolidness(df::SPECTRAL);
+        p_t->setPosition(df::Vector((float)i, 2.0f));
+        p_t->setVelocity(df::Vector(0.5f, (float)(i % 3)));
+        movers.push_back(p_t);
+    }
+    movers[3]->setVelocity(df::Vector(0, 0));
+    movers[7]->setPosition(df::Vector((float)WM.getHorizontal() - 0.25f, 2.0f));
+    TestObject *p_solid = new TestObject();
+    p_solid->setPosition(df::Vector(40, 20));
+    p_solid->setVelocity(df::Vector(-1, 0));
+    ASSERT_EQ(WM.getMotion().getCount(), before + n + 1, "MotionStore has a slot per Object");
+
+    WM.update();
+    bool moved = true;
+    for (int i = 0; i < n; i++) {
+        if (i == 3 || i == 7) continue;
+        df::Vector pos = movers[i]->getPosition();
+        moved = moved && pos.getX() == (float)i + 0.5f && pos.getY() == 2.0f + (float)(i % 3);
+    }
+    ASSERT_TRUE(moved, "Non-solid objects moved by velocity");
+    ASSERT_EQ(movers[3]->getPosition().getX(), 3.0f, "Object at rest not moved");
+    ASSERT_EQ(movers[7]->out_count, 1, "Object moved out of bounds gets EventOut");
+    ASSERT_EQ(movers[6]->out_count, 0, "Object in bounds gets no EventOut");
+    ASSERT_EQ(p_solid->getPosition().getX(), 39.0f, "Solid object moved by velocity");
+
+    // Deleting an Object moves the last slot into its place
+    delete movers[0];
+    delete movers[5];
+    ASSERT_EQ(WM.getMotion().getCount(), before + n - 1, "Deleted Objects free their slots");
+    ASSERT_EQ(p_solid->getPosition().getX(), 39.0f, "Moved slot keeps position");
+    ASSERT_EQ(p_solid->getVelocity().getX(), -1.0f, "Moved slot keeps velocity");
+    ASSERT_EQ(movers[10]->getPosition().getX(), 10.5f, "Other slots unchanged");
+
+    for (int i = 1; i < n; i++) {
+        if (i != 5) delete movers[i];
+    }
+    delete p_solid;
+    ASSERT_EQ(WM.getMotion().getCount(), before, "All motion slots freed");
+}
+
 // -----------------------------------------------------------------------
 // WORLDMANAGER TESTS
 // -----------------------------------------------------------------------
@@ -326,6 +571,25 @@ void testWorldManager() {
     ASSERT_EQ(typeA.getCount(), 1, "objectsOfType TypeA count = 1");
     ASSERT_EQ(typeA[0], p1, "objectsOfType TypeA returns p1");
 
+    // Type index follows setType and cached list pointers stay current
+    const df::ObjectList *p_type_c = WM.getTypeList("TypeC");
+    ASSERT_EQ(p_type_c->getCount(), 0, "getTypeList for new type is empty");
+    p2->setType("TypeC");
+    ASSERT_EQ(p_type_c->getCount(), 1, "Cached type list sees setType change");
+    ASSERT_EQ(WM.objectsOfType("TypeB").getCount(), 0, "Object left old type bucket");
+    ASSERT_EQ(WM.objectsOfType("NoSuchType").getCount(), 0,
+              "objectsOfType unknown type is empty");
+    int unknown_visited = 0;
+    for (df::Object *p_o : WM.objectsOfTypeView("NoSuchType")) {
+        if (p_o != nullptr) unknown_visited++;
+    }
+    ASSERT_EQ(unknown_visited, 0, "View over unknown type visits nothing");
+    int type_a_visited = 0;
+    for (df::Object *p_o : WM.objectsOfTypeView("TypeA")) {
+        if (p_o == p1) type_a_visited++;
+    }
+    ASSERT_EQ(type_a_visited, 1, "View over type visits its Objects");
+
     // markForDelete (deferred deletion)
     WM.markForDelete(p1);
     // Before update, p1 still there
@@ -340,6 +604,10 @@ void testWorldManager() {
     delete p2; // destructor calls WM.removeObject
     ASSERT_EQ(WM.getAllObjects().getCount(), before,
               "removeObject via destructor: count back to start");
+    ASSERT_EQ(p_type_c->getCount(), 0, "Deleted object removed from type bucket");
+
+    testBatchDelete();
+    testMotionStore();
 
     LM.writeLog("WorldManager tests complete.");
 }
@@ -347,6 +615,15 @@ void testWorldManager() {
 // -----------------------------------------------------------------------
 // LOGMANAGER TESTS
 // -----------------------------------------------------------------------
+// Wait for the log writer, then return the log file contents
+static std::string readLogFile() {
+    LM.drain();
+    std::ifstream log_file(LOGFILE_DEFAULT);
+    std::stringstream contents;
+    contents << log_file.rdbuf();
+    return contents.str();
+}
+
 void testLogManager() {
     std::cout << "\n--- LogManager Tests ---\n";
 
@@ -365,9 +642,266 @@ void testLogManager() {
     int r4 = LM.writeLog("LogManager test: string %s", "hello");
     ASSERT_TRUE(r4 >= 0, "writeLog with string arg");
 
+    // Deferred formatting: record written later by the writer thread,
+    // string argument copied so the caller's buffer can go away
+    {
+        std::string temp = "transient";
+        LM.writeLog("LogManager test: deferred %s %d %.1f", temp.c_str(), 7, 2.5);
+        temp = "overwritten";
+    }
+    ASSERT_TRUE(readLogFile().find("] INFO  LogManager test: deferred transient 7 2.5\n")
+                != std::string::npos, "Queued record written with copied arguments");
+    {
+        std::string fmt = "LogManager test: format from a heap buffer %d";
+        LM.writeLog(fmt.c_str(), 8);
+        fmt.assign(fmt.size(), '?');
+    }
+    ASSERT_TRUE(readLogFile().find("] INFO  LogManager test: format from a heap buffer 8\n")
+                != std::string::npos, "Non-literal format copied");
+    ASSERT_EQ(LM.getFullPolicy(), df::LOG_DROP, "Default full-queue policy is drop");
+    ASSERT_EQ(LM.getDropped(), 0L, "No records dropped");
+
+    // Severity levels and runtime threshold
+    df::LogLevel old_level = LM.getLevel();
+    LM.setLevel(df::LOG_WARN);
+    ASSERT_EQ(LM.getLevel(), df::LOG_WARN, "setLevel/getLevel");
+    ASSERT_TRUE(!LM.isLogged(df::LOG_INFO), "INFO below WARN threshold");
+    ASSERT_TRUE(LM.isLogged(df::LOG_ERROR), "ERROR above WARN threshold");
+    int evaluated = 0;
+    DF_LOG_INFO("LogManager test: filtered info %d", ++evaluated);
+    DF_LOG_DEBUG("LogManager test: filtered debug %d", ++evaluated);
+    ASSERT_EQ(evaluated, 0, "Filtered macro arguments not evaluated");
+    ASSERT_EQ(LM.writeLog("LogManager test: filtered plain"), 0,
+              "Filtered writeLog is not an error");
+    DF_LOG_WARN("LogManager test: warn %d", ++evaluated);
+    ASSERT_EQ(evaluated, 1, "Passing macro arguments evaluated once");
+    LM.writeLog(df::LOG_ERROR, "LogManager test: error");
+    LM.setLevel(old_level);
+    std::string contents = readLogFile();
+    ASSERT_TRUE(contents.find("filtered") == std::string::npos,
+                "Filtered messages not written");
+    ASSERT_TRUE(contents.find("] WARN  LogManager test: warn 1\n") != std::string::npos,
+                "WARN message written with level");
+    ASSERT_TRUE(contents.find("] ERROR LogManager test: error\n") != std::string::npos,
+                "ERROR message written with level");
+
     LM.writeLog("LogManager tests complete.");
 }
 
+// -----------------------------------------------------------------------
+// LOG RECORD TESTS (argument encoding and deferred formatting)
+// -----------------------------------------------------------------------
+static std::string formatDeferred(const char *fmt, ...) {
+    unsigned char args_buf[LOG_RECORD_ARG_BYTES];
+    va_list args;
+    va_start(args, fmt);
+    int size = df::encodeLogArgs(fmt, args, args_buf, sizeof(args_buf));
+    va_end(args);
+    char out[LOG_MESSAGE_MAX];
+    df::formatLogArgs(fmt, args_buf, size, out, sizeof(out));
+    return out;
+}
+
+void testLogRecord() {
+    std::cout << "\n--- Log Record Tests ---\n";
+
+    ASSERT_EQ(formatDeferred("plain"), std::string("plain"), "No conversions");
+    ASSERT_EQ(formatDeferred("%d %u %x", -5, 7u, 255u), std::string("-5 7 ff"),
+              "Integer conversions");
+    ASSERT_EQ(formatDeferred("%ld %lld %zu", -1L, 1LL << 40, (size_t)9),
+              std::string("-1 1099511627776 9"), "Length modifiers");
+    ASSERT_EQ(formatDeferred("%5.2f|%-4s|%c", 3.14159, "ab", 'z'),
+              std::string(" 3.14|ab  |z"), "Width, precision, flags");
+    ASSERT_EQ(formatDeferred("%*d|%.*s", 4, 42, 3, "abcdef"),
+              std::string("  42|abc"), "Star width and precision");
+    ASSERT_EQ(formatDeferred("100%% %s", (const char *)nullptr),
+              std::string("100% (null)"), "Percent literal and null string");
+    ASSERT_EQ(formatDeferred("%hhd %hu", 300, 70000), std::string("44 4464"),
+              "Short conversions truncate like printf");
+
+    // Long strings are truncated to fit the record, never overrun it
+    std::string long_str(500, 'x');
+    std::string out = formatDeferred("%s|%d", long_str.c_str(), 5);
+    ASSERT_TRUE(out.size() < long_str.size(), "Oversized string truncated");
+
+    LM.writeLog("Log record tests complete.");
+}
+
+// -----------------------------------------------------------------------
+// POOL ALLOCATOR TESTS
+// -----------------------------------------------------------------------
+class PooledThing : public df::Object, public df::Pooled {
+public:
+    int payload[8] = {};
+    PooledThing() { setType("PooledThing"); }
+};
+
+void testPoolAllocator() {
+    std::cout << "\n--- Pool Allocator Tests ---\n";
+
+    df::PoolAllocator pool(24);
+    ASSERT_EQ(pool.getBlockSize(), (size_t)32, "Block size rounded to granularity");
+    std::vector<void *> blocks;
+    size_t per_slab = POOL_SLAB_BYTES / 32;
+    for (size_t i = 0; i < per_slab + 1; i++) {
+        blocks.push_back(pool.allocate());
+    }
+    ASSERT_EQ(pool.getSlabCount(), (size_t)2, "Second slab added when first is full");
+    ASSERT_EQ(pool.getInUse(), per_slab + 1, "In-use count");
+    ASSERT_TRUE((char *)blocks[1] - (char *)blocks[0] == 32, "Fresh slab hands out contiguous blocks");
+    bool aligned = true;
+    for (void *p : blocks) {
+        if ((size_t)p % POOL_GRANULARITY != 0) aligned = false;
+    }
+    ASSERT_TRUE(aligned, "Blocks aligned to granularity");
+    void *p_last = blocks.back();
+    pool.deallocate(p_last);
+    ASSERT_TRUE(pool.allocate() == p_last, "Freed block reused first");
+    for (void *p : blocks) {
+        pool.deallocate(p);
+    }
+    ASSERT_EQ(pool.getInUse(), (size_t)0, "All blocks returned");
+    ASSERT_TRUE(df::poolFor(POOL_MAX_BLOCK + 1) == nullptr, "Large sizes not pooled");
+
+    // Pooled Object subclass, including deferred deletion by WorldManager
+    df::PoolAllocator *p_pool = df::poolFor(sizeof(PooledThing));
+    size_t in_use = p_pool->getInUse();
+    PooledThing *p_a = new PooledThing();
+    ASSERT_EQ(p_pool->getInUse(), in_use + 1, "Pooled object allocated from pool");
+    delete p_a;
+    ASSERT_EQ(p_pool->getInUse(), in_use, "delete returns block to pool");
+    PooledThing *p_b = new PooledThing();
+    ASSERT_TRUE((void *)p_b == (void *)p_a, "Next pooled object reuses freed block");
+    df::Object *p_base = new PooledThing();
+    WM.markForDelete(p_b);
+    WM.markForDelete(p_base);
+    WM.update();
+    ASSERT_EQ(p_pool->getInUse(), in_use, "Deferred deletion returns blocks to pool");
+}
+
+// -----------------------------------------------------------------------
+// PROFILER TEST
+// -----------------------------------------------------------------------
+void testProfiler() {
+    std::cout << "\n--- Profiler Tests ---\n";
+
+    // Macros compile to nothing unless built with DF_PROFILE
+    DF_PROFILE_FRAME();
+    DF_PROFILE_SCOPE("test macro");
+
+    PROF.beginFrame();
+    int frame = PROF.getFrame();
+    {
+        df::ProfileScope outer("test outer");
+        df::ProfileScope inner("test inner");
+    }
+    PROF.setEnabled(false);
+    {
+        df::ProfileScope skipped("test disabled");
+    }
+    PROF.setEnabled(true);
+
+    std::vector<df::ProfileSample> samples = PROF.getSamples(1);
+    const df::ProfileSample *p_outer = nullptr, *p_inner = nullptr;
+    bool saw_disabled = false;
+    for (const df::ProfileSample &s : samples) {
+        std::string name = s.name;
+        if (name == "test outer") p_outer = &s;
+        if (name == "test inner") p_inner = &s;
+        if (name == "test disabled") saw_disabled = true;
+    }
+    ASSERT_TRUE(p_outer != nullptr && p_inner != nullptr, "Scopes recorded");
+    ASSERT_TRUE(!saw_disabled, "Nothing recorded while disabled");
+    if (p_outer != nullptr && p_inner != nullptr) {
+        ASSERT_TRUE(p_outer->start_ns <= p_inner->start_ns
+                    && p_inner->end_ns <= p_outer->end_ns, "Inner scope nests in outer");
+        ASSERT_EQ(p_outer->frame, frame, "Sample tagged with frame");
+    }
+
+    PROF.beginFrame();
+    bool old_frame_kept = false;
+    for (const df::ProfileSample &s : PROF.getSamples(1)) {
+        if (std::string(s.name) == "test outer") old_frame_kept = true;
+    }
+    ASSERT_TRUE(!old_frame_kept, "getSamples limited to last frames");
+
+    ASSERT_EQ(PROF.dumpTrace("dragonfly_trace.json", 2), 0, "dumpTrace writes file");
+    std::ifstream trace_file("dragonfly_trace.json");
+    std::stringstream trace;
+    trace << trace_file.rdbuf();
+    ASSERT_TRUE(trace.str().find("\"traceEvents\":[") != std::string::npos
+                && trace.str().find("{\"name\":\"test inner\",\"ph\":\"X\"") != std::string::npos,
+                "Trace is trace_event JSON with the regions");
+    std::remove("dragonfly_trace.json");
+
+    // Reading while another thread wraps its ring: no torn samples
+    std::atomic<bool> racing(true);
+    std::thread racer([&racing]() {
+        for (std::int64_t k = 0; racing || k < 3 * PROFILE_SAMPLES_DEFAULT; k++) {
+            PROF.record("test racer", k, k + 1);
+        }
+    });
+    bool torn = false;
+    for (int i = 0; i < 20; i++) {
+        for (const df::ProfileSample &s : PROF.getSamples(1)) {
+            if (std::string(s.name) == "test racer" && s.end_ns != s.start_ns + 1) torn = true;
+        }
+    }
+    racing = false;
+    racer.join();
+    ASSERT_TRUE(!torn, "Samples read while recorded are whole");
+}
+
+// -----------------------------------------------------------------------
+// BINARY LOG TEST (write in binary mode, decode back to text)
+// -----------------------------------------------------------------------
+void testLogBinary() {
+    std::cout << "\n--- Binary Log Tests ---\n";
+
+    ASSERT_EQ(LM.setBinary(true), 0, "setBinary before startUp");
+    ASSERT_EQ(LM.startUp(), 0, "LogManager starts in binary mode");
+    ASSERT_EQ(LM.setBinary(false), -1, "setBinary fails once started");
+    for (int i = 0; i < 3; i++) {
+        LM.writeLog("Binary test: record %d of %s", i, "three");
+    }
+    LM.writeLog(df::LOG_WARN, "Binary test: %.2f %c %%", 1.5, 'x');
+
+    // A reused format buffer is identified by its text, not its address
+    char reused[32];
+    std::snprintf(reused, sizeof(reused), "Binary test: first %%d");
+    LM.writeLog(reused, 1);
+    LM.drain();
+    std::snprintf(reused, sizeof(reused), "Binary test: second %%d");
+    LM.writeLog(reused, 2);
+    LM.shutDown();
+    LM.setBinary(false);
+
+    std::ifstream in(LOGFILE_BINARY_DEFAULT, std::ifstream::binary);
+    std::stringstream text;
+    ASSERT_EQ(df::decodeLogBinary(in, text), 0, "Binary log decodes");
+    std::string decoded = text.str();
+    ASSERT_TRUE(decoded.find("] INFO  Binary test: record 0 of three\n") != std::string::npos
+                && decoded.find("] INFO  Binary test: record 2 of three\n") != std::string::npos,
+                "Records decoded with arguments");
+    ASSERT_TRUE(decoded.find("] WARN  Binary test: 1.50 x %\n") != std::string::npos,
+                "Level and mixed arguments decoded");
+    ASSERT_TRUE(decoded.find("Binary test: first 1\n") != std::string::npos
+                && decoded.find("Binary test: second 2\n") != std::string::npos,
+                "Reused format buffer decoded with its current text");
+
+    // Repeated format stored once
+    in.clear();
+    in.seekg(0);
+    std::string raw((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    size_t first = raw.find("Binary test: record %d");
+    ASSERT_TRUE(first != std::string::npos
+                && raw.find("Binary test: record %d", first + 1) == std::string::npos,
+                "Format string written once");
+
+    std::stringstream bad("not a log"), out;
+    ASSERT_EQ(df::decodeLogBinary(bad, out), -1, "Bad header rejected");
+}
+
 // -----------------------------------------------------------------------
 // STEP EVENT via GameManager onEvent TEST
 // -----------------------------------------------------------------------
@@ -385,7 +919,20 @@ void testStepEvent() {
     GM.onEvent(&es);
     ASSERT_EQ(p_t->step_count, before + 3, "Multiple step events delivered");
 
+    // Only interested objects receive events
+    TestObject *p_quiet = new TestObject();
+    p_quiet->unregisterInterest(STEP_EVENT);
+    int handled = GM.onEvent(&es);
+    ASSERT_EQ(p_quiet->step_count, 0, "Unregistered object gets no step event");
+    ASSERT_EQ(handled, 1, "onEvent counts only interested objects");
+    ASSERT_EQ(p_quiet->unregisterInterest(STEP_EVENT), -1,
+              "unregisterInterest twice returns -1");
+
+    // Deleted object is no longer dispatched to
     delete p_t;
+    ASSERT_EQ(GM.onEvent(&es), 0, "Deleted object unregistered from step events");
+
+    delete p_quiet;
     LM.writeLog("Step event tests complete.");
 }
 
@@ -415,11 +962,728 @@ void testEventDispatch() {
     p_a->eventHandler(&eo);
     ASSERT_EQ(p_a->out_count, 1, "Object received out-of-bounds event");
 
+    // Same dispatch for an Object using type ids
+    IdTestObject *p_id = new IdTestObject();
+    df::EventStep es(1);
+    GM.onEvent(&es);
+    ASSERT_EQ(p_id->step_count, 1, "Id-registered Object stepped");
+    ASSERT_EQ(p_a->step_count, 1, "Name-registered Object stepped alongside");
+    p_id->eventHandler(&ec);
+    p_id->eventHandler(&eo);
+    ASSERT_EQ(p_id->collision_count, 1, "Id check sees collision event");
+    ASSERT_EQ(p_id->out_count, 1, "Id check sees out-of-bounds event");
+    ASSERT_EQ(p_id->unregisterInterest(STEP_EVENT), 0, "Unregister by name after id");
+    GM.onEvent(&es);
+    ASSERT_EQ(p_id->step_count, 1, "Unregistered by name: not stepped");
+
+    delete p_id;
     delete p_a;
     delete p_b;
     LM.writeLog("Event dispatch tests complete.");
 }
 
+// -----------------------------------------------------------------------
+// COLLISION TESTS (WorldManager::update movement through sort-and-sweep boxes)
+// -----------------------------------------------------------------------
+// Mover that appends its collisions to a shared trace, by creation index
+class TraceMover : public df::Object {
+public:
+    int index;
+    std::string *p_trace;
+    TraceMover(int i, std::string *p_t) : index(i), p_trace(p_t) {
+        setType("TraceMover");
+    }
+    int eventHandler(const df::Event *p_e) override {
+        if (p_e->getTypeId() != COLLISION_EVENT_ID) return 0;
+        const df::EventCollision *p_c = static_cast<const df::EventCollision *>(p_e);
+        const TraceMover *p_other = static_cast<const TraceMover *>(
+            p_c->getObject1() == this ? p_c->getObject2() : p_c->getObject1());
+        *p_trace += std::to_string(index) + ">" + std::to_string(p_other->index) + " ";
+        return 1;
+    }
+};
+
+// Run a crowded scene for a few updates; return collision trace and
+// final positions
+static std::string runMoveScene(int workers) {
+    GM.setWorkerCount(workers);
+    std::string trace;
+    std::srand(7);
+    std::vector<TraceMover *> movers;
+    for (int i = 0; i < 2000; i++) {
+        TraceMover *p_m = new TraceMover(i, &trace);
+        p_m->setSolidness(i % 3 == 0 ? df::SOFT : df::HARD);
+        p_m->setPosition(df::Vector((float)(std::rand() % 40), (float)(std::rand() % 20)));
+        if (i % 4 != 0) {
+            p_m->setVelocity(df::Vector((float)(std::rand() % 3 - 1), (float)(std::rand() % 3 - 1)));
+        }
+        movers.push_back(p_m);
+    }
+    for (int u = 0; u < 5; u++) {
+        WM.update();
+    }
+    for (TraceMover *p_m : movers) {
+        trace += std::to_string((int)p_m->getPosition().getX()) + "," +
+                 std::to_string((int)p_m->getPosition().getY()) + " ";
+        delete p_m;
+    }
+    return trace;
+}
+
+void testBoxCollision() {
+    // Box basics
+    df::Box a(df::Vector(0, 0), 2, 2);
+    ASSERT_TRUE(a.intersects(df::Box(df::Vector(1, 1), 2, 2)), "Overlapping boxes intersect");
+    ASSERT_TRUE(!a.intersects(df::Box(df::Vector(2, 0), 1, 1)), "Touching boxes don't intersect");
+    ASSERT_TRUE(a.translated(df::Vector(3, 4)) == df::Box(df::Vector(3, 4), 2, 2),
+                "Box translated");
+    ASSERT_TRUE(a.merged(df::Box(df::Vector(5, -1), 1, 1)) == df::Box(df::Vector(0, -1), 6, 3),
+                "Boxes merged");
+
+    // Default box follows shape, placed at the position's cell
+    TestObject *p_ship = new TestObject();
+    ASSERT_TRUE(p_ship->getBox() == df::Box(df::Vector(0, 0), 1, 1), "Default box is one cell");
+    p_ship->setShape("<===>");
+    ASSERT_TRUE(p_ship->getBox() == df::Box(df::Vector(0, 0), 5, 1), "Box from shape width");
+    p_ship->setPosition(df::Vector(10.5f, 5.25f));
+    ASSERT_TRUE(p_ship->getWorldBox() == df::Box(df::Vector(10, 5), 5, 1),
+                "World box at position's cell");
+
+    // A mover hits any part of a wide Object, not just its anchor
+    TestObject *p_bullet = new TestObject();
+    p_bullet->setPosition(df::Vector(13, 6));
+    p_bullet->setVelocity(df::Vector(0, -1));
+    WM.update();
+    ASSERT_EQ(p_bullet->collision_count, 1, "Bullet hits side of wide ship");
+    ASSERT_EQ(p_ship->collision_count, 1, "Wide ship gets collision");
+    ASSERT_EQ(p_bullet->getPosition().getY(), 6.0f, "Bullet blocked by wide ship");
+
+    // A wide mover is blocked by what its far edge runs into
+    p_bullet->setVelocity(df::Vector(0, 0));
+    p_bullet->setPosition(df::Vector(16, 5));
+    p_ship->setVelocity(df::Vector(1, 0));
+    WM.update();
+    ASSERT_EQ(p_ship->getPosition().getX(), 11.5f, "Wide ship moves while clear");
+    WM.update();
+    ASSERT_EQ(p_ship->collision_count, 2, "Wide ship's front edge collides");
+    ASSERT_EQ(p_ship->getPosition().getX(), 11.5f, "Wide ship blocked by front edge");
+
+    // Custom box
+    p_ship->setVelocity(df::Vector(0, 0));
+    p_bullet->setBox(df::Box(df::Vector(0, -3), 1, 4)); // tall: rows 2 to 5
+    p_bullet->setPosition(df::Vector(30, 5));
+    TestObject *p_mover = new TestObject();
+    p_mover->setPosition(df::Vector(29, 2));
+    p_mover->setVelocity(df::Vector(1, 0));
+    WM.update();
+    ASSERT_EQ(p_mover->collision_count, 1, "Mover hits top of tall custom box");
+
+    delete p_ship;
+    delete p_bullet;
+    delete p_mover;
+
+    // Sorted boxes stay right as Objects are deleted, made spectral, added
+    // and moved between updates
+    std::vector<TestObject *> walls;
+    for (int i = 0; i < 30; i++) {
+        TestObject *p_wall = new TestObject();
+        p_wall->setPosition(df::Vector(40.0f + (float)(i % 10) * 3, 10.0f + (float)(i / 10) * 3));
+        walls.push_back(p_wall);
+    }
+    WM.update();
+    delete walls[4];                          // was at (52, 10)
+    walls[4] = nullptr;
+    walls[5]->setSolidness(df::SPECTRAL);     // at (55, 10)
+    walls[12]->setPosition(df::Vector(60, 19)); // from (46, 13)
+    TestObject *p_late = new TestObject();
+    p_late->setPosition(df::Vector(62, 16));
+    TestObject *probes[5];
+    const float probe_at[5][2] = {{51, 10}, {54, 10}, {57, 10}, {63, 16}, {59, 19}};
+    for (int i = 0; i < 5; i++) {
+        probes[i] = new TestObject();
+        probes[i]->setPosition(df::Vector(probe_at[i][0], probe_at[i][1]));
+        probes[i]->setVelocity(df::Vector(i == 3 ? -1.0f : 1.0f, 0));
+    }
+    WM.update();
+    ASSERT_EQ(probes[0]->collision_count, 0, "No collision with deleted Object");
+    ASSERT_EQ(probes[1]->collision_count, 0, "No collision with spectral Object");
+    ASSERT_EQ(probes[2]->collision_count, 1, "Collision with remaining Object");
+    ASSERT_EQ(probes[3]->collision_count, 1, "Collision with Object added since sort");
+    ASSERT_EQ(probes[4]->collision_count, 1, "Collision with Object moved since sort");
+    for (TestObject *p_o : probes) {
+        delete p_o;
+    }
+    for (TestObject *p_o : walls) {
+        delete p_o;
+    }
+    delete p_late;
+
+    // Sorted boxes stay right when most of them jump far between updates
+    std::vector<TestObject *> row;
+    for (int i = 0; i < 200; i++) {
+        TestObject *p_wall = new TestObject();
+        p_wall->setPosition(df::Vector(100.0f + (float)i * 2, 30));
+        row.push_back(p_wall);
+    }
+    WM.update();
+    for (int i = 0; i < 200; i++) {
+        row[i]->setPosition(df::Vector(100.0f + (float)(199 - i) * 2, 40));
+    }
+    TestObject *row_probes[3];
+    const int probe_gap[3] = {0, 57, 198};
+    for (int i = 0; i < 3; i++) {
+        row_probes[i] = new TestObject();
+        row_probes[i]->setPosition(df::Vector(101.0f + (float)probe_gap[i] * 2, 40));
+        row_probes[i]->setVelocity(df::Vector(1, 0));
+    }
+    WM.update();
+    for (int i = 0; i < 3; i++) {
+        ASSERT_EQ(row_probes[i]->collision_count, 1, "Collision after most boxes jumped");
+        delete row_probes[i];
+    }
+    for (TestObject *p_o : row) {
+        delete p_o;
+    }
+}
+
+void testSweptCollision() {
+    TestObject *p_wall = new TestObject();
+    TestObject *p_bullet = new TestObject();
+    p_wall->setPosition(df::Vector(20, 5));
+    p_bullet->setPosition(df::Vector(10.5f, 5.5f));
+    p_bullet->setVelocity(df::Vector(7, 0));
+
+    // Without sweeping the bullet skips over the wall's cell
+    WM.update();
+    WM.update();
+    ASSERT_EQ(p_bullet->collision_count, 0, "Unswept fast mover tunnels through wall");
+    ASSERT_EQ(p_bullet->getPosition().getX(), 24.5f, "Unswept fast mover lands past wall");
+
+    WM.setSweptCollisions();
+    ASSERT_TRUE(WM.isSweptCollisions(), "Swept collisions on");
+    p_bullet->setPosition(df::Vector(10.5f, 5.5f));
+    WM.update();
+    ASSERT_EQ(p_bullet->collision_count, 0, "Swept mover clear of wall moves freely");
+    ASSERT_EQ(p_bullet->getPosition().getX(), 17.5f, "Swept mover moves full velocity");
+    WM.update();
+    ASSERT_EQ(p_bullet->collision_count, 1, "Swept mover hits wall in between");
+    ASSERT_EQ(p_wall->collision_count, 1, "Wall gets swept collision");
+    ASSERT_TRUE(p_bullet->last_collision == df::Vector(20, 5.5f),
+                "Collision position is the contact point");
+    float x = p_bullet->getPosition().getX();
+    ASSERT_TRUE(x < 20.0f && x > 19.99f, "Blocked mover stops against wall");
+
+    // SOFT movers get the event and pass through
+    p_bullet->setSolidness(df::SOFT);
+    WM.update();
+    ASSERT_EQ(p_bullet->collision_count, 2, "SOFT swept mover collides");
+    ASSERT_TRUE(p_bullet->getPosition().getX() > 26.0f, "SOFT swept mover not blocked");
+
+    // Diagonal moves walk the cells in between
+    p_bullet->setSolidness(df::HARD);
+    p_wall->setPosition(df::Vector(2, 2));
+    p_bullet->setPosition(df::Vector(0.5f, 0.25f));
+    p_bullet->setVelocity(df::Vector(3, 3));
+    WM.update();
+    ASSERT_EQ(p_bullet->collision_count, 3, "Diagonal swept mover hits wall");
+    df::Vector stop = p_bullet->getPosition();
+    ASSERT_TRUE((int)stop.getX() == 2 && (int)stop.getY() == 1,
+                "Diagonal mover stops in cell before wall");
+    ASSERT_TRUE(p_bullet->last_collision == df::Vector(2.25f, 2),
+                "Diagonal contact where path enters wall cell");
+    p_bullet->setVelocity(df::Vector(0, 0));
+
+    // A later mover heading where a blocked swept mover stops finds it
+    TestObject *p_fast = new TestObject();
+    TestObject *p_stop_wall = new TestObject();
+    TestObject *p_late = new TestObject();
+    p_fast->setPosition(df::Vector(0.5f, 0.5f));
+    p_fast->setVelocity(df::Vector(20, 0));
+    p_stop_wall->setPosition(df::Vector(10.5f, 0.5f));
+    p_late->setPosition(df::Vector(9.5f, 1.5f));
+    p_late->setVelocity(df::Vector(0, -1));
+    WM.update();
+    float fast_x = p_fast->getPosition().getX();
+    ASSERT_TRUE(fast_x < 10.0f && fast_x > 9.99f, "Swept mover stops short of wall");
+    ASSERT_EQ(p_late->collision_count, 1, "Later mover collides with stopped mover");
+    ASSERT_TRUE(!p_late->getWorldBox().intersects(p_fast->getWorldBox()),
+                "Later mover blocked outside stopped mover's cell");
+    delete p_fast;
+    delete p_stop_wall;
+    delete p_late;
+
+    WM.setSweptCollisions(false);
+    delete p_wall;
+    delete p_bullet;
+}
+
+void testDeterministicMoves() {
+    int old_workers = GM.getWorkerCount();
+    std::string serial = runMoveScene(0);
+    std::string parallel = runMoveScene(3);
+    GM.setWorkerCount(old_workers);
+    ASSERT_TRUE(serial.find('>') != std::string::npos, "Crowded scene has collisions");
+    ASSERT_TRUE(serial == parallel, "Same events and positions with 0 and 3 job threads");
+
+    // Two HARD movers headed for one cell: the lower id gets there first
+    std::string trace;
+    TraceMover *p_first = new TraceMover(1, &trace);
+    TraceMover *p_second = new TraceMover(2, &trace);
+    p_second->setPosition(df::Vector(5, 5));
+    p_second->setVelocity(df::Vector(1, 0));
+    p_first->setPosition(df::Vector(7, 5));
+    p_first->setVelocity(df::Vector(-1, 0));
+    WM.update();
+    ASSERT_TRUE(p_first->getPosition() == df::Vector(6, 5), "Lower id mover moved");
+    ASSERT_TRUE(p_second->getPosition() == df::Vector(5, 5), "Higher id mover blocked");
+    ASSERT_EQ(trace, std::string("2>1 1>2 "), "Collision sent to mover, then other");
+    delete p_first;
+    delete p_second;
+}
+
+void testCollision() {
+    std::cout << "\n--- Collision Tests ---\n";
+
+    TestObject *p_mover = new TestObject();
+    TestObject *p_wall  = new TestObject();
+    p_mover->setPosition(df::Vector(10, 5));
+    p_wall->setPosition(df::Vector(11, 5));
+    p_mover->setVelocity(df::Vector(1, 0));
+
+    // HARD into HARD: both get collision event, mover is blocked
+    WM.update();
+    ASSERT_EQ(p_mover->collision_count, 1, "Mover received collision event");
+    ASSERT_EQ(p_wall->collision_count, 1, "Wall received collision event");
+    ASSERT_EQ(p_mover->getPosition().getX(), 10.0f, "HARD-HARD collision blocks movement");
+
+    // SOFT mover: collision event but movement proceeds
+    p_mover->setSolidness(df::SOFT);
+    WM.update();
+    ASSERT_EQ(p_mover->collision_count, 2, "SOFT mover received collision event");
+    ASSERT_EQ(p_mover->getPosition().getX(), 11.0f, "SOFT mover is not blocked");
+
+    // Wall moved away: no collision at its old cell
+    p_mover->setPosition(df::Vector(10, 5));
+    p_mover->setSolidness(df::HARD);
+    p_wall->setPosition(df::Vector(30, 5));
+    WM.update();
+    ASSERT_EQ(p_wall->collision_count, 2, "No collision after wall moves away");
+    ASSERT_EQ(p_mover->getPosition().getX(), 11.0f, "Mover moves into vacated cell");
+
+    // SPECTRAL objects never collide
+    p_wall->setSolidness(df::SPECTRAL);
+    p_wall->setPosition(df::Vector(12, 5));
+    WM.update();
+    ASSERT_EQ(p_wall->collision_count, 2, "SPECTRAL object does not collide");
+    ASSERT_EQ(p_mover->getPosition().getX(), 12.0f, "Mover passes through SPECTRAL object");
+
+    delete p_mover;
+    delete p_wall;
+
+    testDeterministicMoves();
+    testSweptCollision();
+    testBoxCollision();
+    LM.writeLog("Collision tests complete.");
+}
+
+// -----------------------------------------------------------------------
+// SLEEP TESTS (asleep Objects skipped by movement and step events)
+// -----------------------------------------------------------------------
+void testSleep() {
+    std::cout << "\n--- Sleep Tests ---\n";
+
+    df::MotionStore &motion = WM.getMotion();
+    int awake_before = motion.getAwakeCount();
+    TestObject *p_a = new TestObject();
+    TestObject *p_b = new TestObject();
+    TestObject *p_c = new TestObject();
+    p_a->setPosition(df::Vector(1, 1));
+    p_b->setPosition(df::Vector(2, 2));
+    p_c->setPosition(df::Vector(3, 3));
+    ASSERT_TRUE(p_a->isAwake(), "Objects start awake");
+    ASSERT_EQ(motion.getAwakeCount(), awake_before + 3, "New Objects have awake slots");
+
+    // Sleeping swaps slots; every Object keeps its own motion
+    p_a->setAwake(false);
+    ASSERT_TRUE(!p_a->isAwake(), "Object put to sleep");
+    ASSERT_EQ(motion.getAwakeCount(), awake_before + 2, "Asleep slot leaves awake slots");
+    ASSERT_TRUE(p_a->getPosition() == df::Vector(1, 1), "Asleep Object keeps position");
+    ASSERT_TRUE(p_b->getPosition() == df::Vector(2, 2), "Swapped Object keeps position");
+    ASSERT_TRUE(p_c->getPosition() == df::Vector(3, 3), "Other Object keeps position");
+    delete p_b; // awake slot freed while an asleep one follows
+    ASSERT_EQ(motion.getAwakeCount(), awake_before + 1, "Deleted awake slot dropped");
+    ASSERT_TRUE(p_a->getPosition() == df::Vector(1, 1), "Asleep slot intact after delete");
+    ASSERT_TRUE(p_c->getPosition() == df::Vector(3, 3), "Awake slot intact after delete");
+
+    // Asleep Objects are not stepped, even if they register while asleep
+    df::EventStep es(1);
+    GM.onEvent(&es);
+    ASSERT_EQ(p_a->step_count, 0, "Asleep Object not stepped");
+    ASSERT_EQ(p_c->step_count, 1, "Awake Object stepped");
+    p_c->setAwake(false);
+    p_c->unregisterInterest(STEP_EVENT_ID);
+    ASSERT_EQ(p_c->registerInterest(STEP_EVENT_ID), 0, "Register while asleep");
+    GM.onEvent(&es);
+    ASSERT_EQ(p_c->step_count, 1, "Object registered while asleep not stepped");
+    p_c->setAwake(true);
+    p_a->setAwake(true);
+    GM.onEvent(&es);
+    ASSERT_EQ(p_a->step_count, 1, "Woken Object stepped");
+    ASSERT_EQ(p_c->step_count, 2, "Object registered while asleep stepped once woken");
+
+    // Asleep Objects don't move; a non-zero velocity wakes them
+    p_a->setSolidness(df::SPECTRAL);
+    p_a->setVelocity(df::Vector(1, 0));
+    p_a->setAwake(false);
+    WM.update();
+    ASSERT_TRUE(p_a->getPosition() == df::Vector(1, 1), "Asleep Object not moved");
+    p_c->setAwake(false);
+    p_c->setVelocity(df::Vector(0, 0));
+    ASSERT_TRUE(!p_c->isAwake(), "Zero velocity doesn't wake");
+    p_c->setVelocity(df::Vector(0, 1));
+    ASSERT_TRUE(p_c->isAwake(), "Non-zero velocity wakes");
+    WM.update();
+    ASSERT_TRUE(p_c->getPosition() == df::Vector(3, 4), "Woken Object moves");
+    p_a->setAwake(true);
+    WM.update();
+    ASSERT_TRUE(p_a->getPosition() == df::Vector(2, 1), "Velocity kept while asleep");
+    delete p_a;
+
+    // Asleep Objects still collide, and a collision wakes them
+    p_c->setVelocity(df::Vector(0, 0));
+    p_c->setPosition(df::Vector(20, 5));
+    TestObject *p_wall = new TestObject();
+    p_wall->setPosition(df::Vector(21, 5));
+    p_wall->setAwake(false);
+    WM.update();
+    p_c->setVelocity(df::Vector(1, 0));
+    WM.update();
+    ASSERT_EQ(p_wall->collision_count, 1, "Asleep Object collided with");
+    ASSERT_TRUE(p_wall->isAwake(), "Collision wakes asleep Object");
+    ASSERT_TRUE(p_c->getPosition() == df::Vector(20, 5), "Asleep HARD Object blocks");
+
+    // An Object deleted while asleep leaves no trace in the step list
+    p_wall->setAwake(false);
+    delete p_wall;
+    delete p_c;
+    ASSERT_EQ(GM.onEvent(&es), 0, "No step events to deleted Objects");
+    ASSERT_EQ(motion.getAwakeCount(), awake_before, "Awake slots back to start");
+    LM.writeLog("Sleep tests complete.");
+}
+
+// -----------------------------------------------------------------------
+// DRAW TESTS (altitude order, visibility)
+// -----------------------------------------------------------------------
+static std::string draw_order;
+
+class DrawRecorder : public df::Object {
+public:
+    char tag;
+    int draw_count = 0;
+    DrawRecorder(char t, int altitude) : tag(t) {
+        setType("DrawRecorder");
+        setAltitude(altitude);
+    }
+    int draw() override {
+        draw_order += tag;
+        draw_count++;
+        return 0;
+    }
+};
+
+// Deletes another Object when drawn
+class DrawDeleter : public DrawRecorder {
+public:
+    df::Object *p_victim = nullptr;
+    DrawDeleter(char t, int altitude) : DrawRecorder(t, altitude) {}
+    int draw() override {
+        delete p_victim;
+        p_victim = nullptr;
+        return DrawRecorder::draw();
+    }
+};
+
+void testDraw() {
+    std::cout << "\n--- Draw Tests ---\n";
+
+    DrawRecorder *p_hi  = new DrawRecorder('h', 4);
+    DrawRecorder *p_lo  = new DrawRecorder('l', 0);
+    DrawRecorder *p_mid = new DrawRecorder('m', 2);
+
+    draw_order.clear();
+    WM.draw();
+    ASSERT_EQ(draw_order, std::string("lmh"), "Objects drawn lowest altitude first");
+
+    p_lo->setAltitude(3);
+    draw_order.clear();
+    WM.draw();
+    ASSERT_EQ(draw_order, std::string("mlh"), "setAltitude changes draw order");
+    p_lo->setAwake(false);
+    p_lo->setAltitude(1);
+    draw_order.clear();
+    WM.draw();
+    ASSERT_EQ(draw_order, std::string("lmh"), "setAltitude of asleep object changes draw order");
+    p_lo->setAwake(true);
+
+    p_mid->setVisible(false);
+    ASSERT_TRUE(!p_mid->isVisible(), "setVisible(false) hides object");
+    draw_order.clear();
+    WM.draw();
+    ASSERT_EQ(draw_order, std::string("lh"), "Invisible object is not drawn");
+
+    p_mid->setVisible(true);
+    draw_order.clear();
+    WM.draw();
+    ASSERT_EQ(p_mid->draw_count, 4, "Visible again: object drawn once per frame");
+
+    DrawDeleter *p_deleter = new DrawDeleter('d', 0);
+    p_deleter->p_victim = p_mid;
+    draw_order.clear();
+    WM.draw();
+    ASSERT_EQ(draw_order, std::string("dlh"), "Object deleted by another's draw() is not drawn");
+    delete p_deleter;
+
+    delete p_hi;
+    delete p_lo;
+    LM.writeLog("Draw tests complete.");
+}
+
+// -----------------------------------------------------------------------
+// VIEW TESTS (world bigger than window, view culling and following)
+// -----------------------------------------------------------------------
+void testView() {
+    std::cout << "\n--- View Tests ---\n";
+
+    df::Box window(df::Vector(), (float)DM.getHorizontal(), (float)DM.getVertical());
+    ASSERT_TRUE(WM.getBoundary() == window, "Boundary defaults to window size");
+    ASSERT_TRUE(WM.getView() == window, "View defaults to window size");
+
+    // Objects inside a boundary bigger than the window aren't out
+    WM.setBoundary(df::Box(df::Vector(), 200, 100));
+    ASSERT_EQ(WM.getHorizontal(), 200, "Horizontal is boundary width");
+    ASSERT_EQ(WM.getVertical(), 100, "Vertical is boundary height");
+    TestObject *p_far = new TestObject();
+    p_far->setSolidness(df::SPECTRAL);
+    p_far->setPosition(df::Vector(150, 80));
+    p_far->setVelocity(df::Vector(1, 0));
+    WM.update();
+    ASSERT_EQ(p_far->out_count, 0, "Past window but inside boundary is not out");
+    p_far->setPosition(df::Vector(199.5f, 80));
+    WM.update();
+    ASSERT_EQ(p_far->out_count, 1, "Past boundary is out");
+    p_far->setVelocity(df::Vector(0, 0));
+
+    // View centers on a position, inside the boundary
+    WM.setViewPosition(df::Vector(100, 50));
+    ASSERT_TRUE(WM.getView().getCorner() == df::Vector(60, 38), "View centered on position");
+    WM.setViewPosition(df::Vector(195, 98));
+    ASSERT_TRUE(WM.getView().getCorner() == df::Vector(120, 76), "View kept inside boundary");
+    WM.setViewPosition(df::Vector(2.5f, 3));
+    ASSERT_TRUE(WM.getView().getCorner() == df::Vector(0, 0), "View kept inside near edges");
+    WM.setViewPosition(df::Vector(100.5f, 50));
+    ASSERT_TRUE(WM.getView().getCorner() == df::Vector(60, 38), "View corner on whole spaces");
+    ASSERT_TRUE(WM.worldToView(df::Vector(61, 39)) == df::Vector(1, 1), "worldToView");
+    ASSERT_TRUE(WM.viewToWorld(df::Vector(1, 1)) == df::Vector(61, 39), "viewToWorld");
+
+    // Drawing is translated to the view
+    DM.swapBuffers();
+    DM.drawCh(df::Vector(61, 39), 'V', df::RED);
+    ASSERT_EQ(DM.getCell(1, 1).ch, 'V', "drawCh translates world to view");
+    DM.drawCh(df::Vector(1, 1), 'W', df::RED);
+    ASSERT_TRUE(DM.getCell(1, 1).ch == 'V', "Off-view drawCh is clipped");
+    DM.drawCh(df::Vector(2, 1), 'H', df::RED, df::BLACK, true);
+    ASSERT_EQ(DM.getCell(2, 1).ch, 'H', "In-view drawCh is not translated");
+    DM.drawString(df::Vector(0, 3), "hud", df::LEFT_JUSTIFIED, df::RED, true);
+    ASSERT_EQ(DM.getCell(1, 3).ch, 'u', "In-view drawString is not translated");
+    DM.swapBuffers();
+
+    // Objects outside the view are culled before draw()
+    DrawRecorder *p_in = new DrawRecorder('i', 0);
+    DrawRecorder *p_out = new DrawRecorder('o', 0);
+    DrawRecorder *p_edge = new DrawRecorder('e', 0);
+    p_in->setPosition(df::Vector(70, 40));
+    p_out->setPosition(df::Vector(5, 5));
+    p_edge->setPosition(df::Vector(58, 40));
+    p_edge->setBox(df::Box(df::Vector(), 3, 1)); // reaches into the view
+    draw_order.clear();
+    WM.draw();
+    // (one altitude is drawn left to right)
+    ASSERT_EQ(draw_order, std::string("ei"), "Only Objects in view drawn");
+    p_edge->setBox(df::Box(df::Vector(), 2, 1));
+    draw_order.clear();
+    WM.draw();
+    ASSERT_EQ(draw_order, std::string("i"), "Box touching view edge culled");
+    p_out->setSolidness(df::SPECTRAL);
+    p_out->setPosition(df::Vector(58.5f, 45));
+    p_out->setVelocity(df::Vector(2, 0));
+    WM.update();
+    draw_order.clear();
+    WM.draw();
+    ASSERT_EQ(draw_order, std::string("oi"), "Non-solid mover drawn once it moves into view");
+    p_out->setVelocity(df::Vector(-20, 0));
+    WM.update();
+    p_out->setVelocity(df::Vector(20, 0));
+    WM.update();
+    p_out->setAwake(false);
+    draw_order.clear();
+    WM.draw();
+    // (awake Objects drawn first)
+    ASSERT_EQ(draw_order, std::string("io"), "Mover asleep since it moved drawn where it stopped");
+    p_out->setAwake(true);
+    p_out->setVelocity(df::Vector(0, 0));
+    p_out->setPosition(df::Vector(5, 5));
+
+    // Following: view centered on the Object each draw
+    WM.setViewFollowing(p_out);
+    ASSERT_TRUE(WM.getViewFollowing() == p_out, "View following Object");
+    ASSERT_TRUE(WM.getView().getCorner() == df::Vector(0, 0), "View moves when following starts");
+    p_out->setPosition(df::Vector(150, 80));
+    draw_order.clear();
+    WM.draw();
+    ASSERT_TRUE(WM.getView().getCorner() == df::Vector(110, 68), "View follows Object");
+    ASSERT_EQ(draw_order, std::string("o"), "Followed Object drawn, others culled");
+    delete p_out;
+    ASSERT_TRUE(WM.getViewFollowing() == nullptr, "Following stops when Object deleted");
+    WM.draw();
+
+    // Objects drawn in view are placed in view spaces, wherever the view is
+    DrawRecorder *p_hud = new DrawRecorder('h', 0);
+    DrawRecorder *p_off_hud = new DrawRecorder('x', 0);
+    p_hud->setDrawnInView();
+    p_off_hud->setDrawnInView();
+    ASSERT_TRUE(p_hud->isDrawnInView(), "setDrawnInView/isDrawnInView");
+    p_off_hud->setPosition(df::Vector(-10, 0));
+    WM.setViewPosition(df::Vector(150, 80));
+    draw_order.clear();
+    WM.draw();
+    ASSERT_EQ(draw_order, std::string("h"), "Drawn in view: kept when view moves, culled off screen");
+    p_hud->setVisible(false);
+    p_off_hud->setDrawnInView(false);
+    p_off_hud->setPosition(df::Vector(130, 70));
+    draw_order.clear();
+    WM.draw();
+    ASSERT_EQ(draw_order, std::string("x"), "Object back in world spaces drawn in view");
+    delete p_hud;
+    delete p_off_hud;
+
+    delete p_in;
+    delete p_edge;
+    delete p_far;
+    WM.setBoundary(window);
+    WM.setView(window);
+    LM.writeLog("View tests complete.");
+}
+
+// -----------------------------------------------------------------------
+// DISPLAY FRAMEBUFFER TESTS (cell grid, dirty-cell diffing)
+// -----------------------------------------------------------------------
+void testDisplay() {
+    std::cout << "\n--- Display Framebuffer Tests ---\n";
+
+    if (DM.isHeadless()) {
+        ASSERT_TRUE(DM.getWindow() == nullptr, "Headless display has no window");
+        ASSERT_EQ(DM.setHeadless(false), -1, "Mode can't change after startUp");
+        ASSERT_EQ(DM.setOffscreen(true), -1, "Offscreen mode can't change after startUp");
+    }
+
+    DM.swapBuffers(); // start from a blank frame
+
+    ASSERT_EQ(DM.drawCh(df::Vector(3.0f, 2.0f), 'A', df::RED), 0, "drawCh returns 0");
+    df::Cell cell = DM.getCell(3, 2);
+    ASSERT_EQ(cell.ch, 'A', "Cell holds drawn character");
+    ASSERT_EQ(cell.fg, df::RED, "Cell holds foreground color");
+    ASSERT_EQ(cell.bg, df::BLACK, "Cell background defaults to BLACK");
+
+    DM.drawString(df::Vector(10.0f, 5.0f), "abc", df::CENTER_JUSTIFIED, df::BLUE);
+    ASSERT_EQ(DM.getCell(8, 5).ch, 'a', "Centered string starts left of position");
+    ASSERT_EQ(DM.getCell(10, 5).ch, 'c', "Centered string ends at position");
+
+    ASSERT_EQ(DM.drawCh(df::Vector(-1.0f, 500.0f), 'X', df::RED), 0,
+              "Off-window drawCh is clipped, not an error");
+    ASSERT_TRUE(DM.getCell(-1, 500) == df::CELL_BLANK, "Out-of-range cell is blank");
+
+    DM.swapBuffers();
+    ASSERT_EQ(DM.getDirtyCount(), 4, "First swap rebuilds the 4 drawn cells");
+    ASSERT_TRUE(DM.getCell(3, 2) == df::CELL_BLANK, "Cells blank after swap");
+
+    // Same picture again: nothing to rebuild
+    DM.drawCh(df::Vector(3.0f, 2.0f), 'A', df::RED);
+    DM.drawString(df::Vector(10.0f, 5.0f), "abc", df::CENTER_JUSTIFIED, df::BLUE);
+    DM.swapBuffers();
+    ASSERT_EQ(DM.getDirtyCount(), 0, "Unchanged frame rebuilds no cells");
+
+    // One character changes color: one cell rebuilt, erased ones rebuilt too
+    DM.drawCh(df::Vector(3.0f, 2.0f), 'A', df::GREEN);
+    DM.swapBuffers();
+    ASSERT_EQ(DM.getDirtyCount(), 4, "Changed and erased cells rebuilt");
+
+    DM.swapBuffers(); // leave a blank frame
+    LM.writeLog("Display framebuffer tests complete.");
+}
+
+// -----------------------------------------------------------------------
+// INJECTED INPUT TESTS
+// -----------------------------------------------------------------------
+class InputRecorder : public df::Object {
+public:
+    int key_count = 0;
+    int mouse_count = 0;
+    df::Key last_key = df::UNDEFINED_KEY;
+    df::Vector last_mouse;
+
+    InputRecorder() {
+        setType("InputRecorder");
+        registerInterest(KEYBOARD_EVENT_ID);
+        registerInterest(MSE_EVENT_ID);
+    }
+
+    int eventHandler(const df::Event *p_e) override {
+        if (p_e->getTypeId() == KEYBOARD_EVENT_ID) {
+            key_count++;
+            last_key = static_cast<const df::EventKeyboard *>(p_e)->getKey();
+            return 1;
+        }
+        if (p_e->getTypeId() == MSE_EVENT_ID) {
+            mouse_count++;
+            last_mouse = static_cast<const df::EventMouse *>(p_e)->getMousePosition();
+            return 1;
+        }
+        return 0;
+    }
+};
+
+void testInput() {
+    std::cout << "\n--- Injected Input Tests ---\n";
+
+    ASSERT_TRUE(IM.isStarted(), "InputManager is started");
+
+    InputRecorder *p_r = new InputRecorder();
+
+    df::EventKeyboard ek;
+    ek.setKey(df::Q);
+    ek.setKeyboardAction(KEY_PRESSED);
+    IM.pushEvent(ek);
+
+    df::EventMouse em;
+    em.setMouseAction(CLICKED);
+    em.setMouseButton(df::LEFT);
+    em.setMousePosition(df::Vector(4.0f, 7.0f));
+    IM.pushEvent(em);
+
+    ASSERT_EQ(p_r->key_count, 0, "Injected input waits for getInput()");
+    IM.getInput();
+    ASSERT_EQ(p_r->key_count, 1, "Injected keyboard event delivered");
+    ASSERT_EQ(p_r->last_key, df::Q, "Injected key value delivered");
+    ASSERT_EQ(p_r->mouse_count, 1, "Injected mouse event delivered");
+    ASSERT_EQ(p_r->last_mouse.getY(), 7.0f, "Injected mouse position delivered");
+
+    IM.getInput();
+    ASSERT_EQ(p_r->key_count, 1, "Injected events delivered only once");
+
+    delete p_r;
+    LM.writeLog("Injected input tests complete.");
+}
+
 // -----------------------------------------------------------------------
 // SHORT GAME LOOP TEST (3 steps, then setGameOver)
 // -----------------------------------------------------------------------
@@ -427,7 +1691,10 @@ class QuitAfterN : public df::Object {
 public:
     int n;
     int count = 0;
-    QuitAfterN(int n_steps) : n(n_steps) { setType("QuitAfterN"); }
+    QuitAfterN(int n_steps) : n(n_steps) {
+        setType("QuitAfterN");
+        registerInterest(STEP_EVENT);
+    }
 
     int eventHandler(const df::Event *p_e) override {
         if (p_e->getType() == STEP_EVENT) {
@@ -442,7 +1709,7 @@ public:
 };
 
 void testGameLoop() {
-    std::cout << "\n--- Game Loop Test (3 steps) ---\n";
+    std::cout << "\n--- Game Loop Tests ---\n";
 
     QuitAfterN *p_q = new QuitAfterN(3);
     GM.setGameOver(false);
@@ -450,24 +1717,219 @@ void testGameLoop() {
     ASSERT_EQ(p_q->count, 3, "Game loop ran exactly 3 steps");
 
     delete p_q;
+
+    // Fixed steps: a mover advances one velocity per step and draws
+    // between its last two positions
+    int steps_before = GM.getStepCount();
+    GM.setRenderTime(GM.getFrameTime() / 4); // several frames per step
+    df::Object *p_mover = new df::Object();
+    p_mover->setSolidness(df::SPECTRAL);
+    p_mover->setPosition(df::Vector(10, 5));
+    p_mover->setVelocity(df::Vector(1, 0));
+    df::Object *p_still = new df::Object();
+    p_still->setPosition(df::Vector(3, 3));
+    ASSERT_TRUE(p_mover->getDrawPosition() == df::Vector(10, 5),
+                "Move outside a step draws at new position");
+    p_q = new QuitAfterN(2);
+    GM.setGameOver(false);
+    GM.run();
+    GM.setRenderTime(0);
+    ASSERT_EQ(GM.getStepCount() - steps_before, 2, "Step count advanced by steps run");
+    ASSERT_TRUE(p_mover->getPosition() == df::Vector(12, 5), "Mover moved once per step");
+    float alpha = GM.getAlpha();
+    ASSERT_TRUE(alpha >= 0.0f && alpha < 1.0f, "Alpha within [0, 1)");
+    df::Vector drawn = p_mover->getDrawPosition();
+    ASSERT_TRUE(std::fabs(drawn.getX() - (11 + alpha)) < 0.001f && drawn.getY() == 5,
+                "Draw position interpolated from previous step");
+    ASSERT_TRUE(p_still->getDrawPosition() == df::Vector(3, 3),
+                "Still object draws at its position");
+    delete p_q;
+
+    // Rendering once per step draws at the step's positions
+    p_q = new QuitAfterN(1);
+    GM.setGameOver(false);
+    GM.run();
+    ASSERT_EQ(GM.getAlpha(), 1.0f, "Alpha 1 when rendering once per step");
+    ASSERT_TRUE(p_mover->getDrawPosition() == p_mover->getPosition(),
+                "Once per step: mover drawn at its position");
+    delete p_q;
+    delete p_mover;
+    delete p_still;
+
+    // Hybrid pacing: steps land on schedule, never early
+    ASSERT_EQ(GM.getPacing(), df::PACE_HYBRID, "Hybrid pacing by default");
+    ASSERT_TRUE(!GM.isVsyncPacing(), "No vsync pacing when headless");
+    int old_frame_time = GM.getFrameTime();
+    GM.setFrameTime(5000);
+    p_q = new QuitAfterN(6);
+    df::Clock clock;
+    GM.setGameOver(false);
+    GM.run();
+    long int took = clock.split();
+    GM.setFrameTime(old_frame_time);
+    ASSERT_TRUE(took >= 5 * 5000, "Six steps at 5 ms take at least 25 ms");
+    ASSERT_TRUE(GM.getOversleep() >= 0, "Oversleep estimate not negative");
+    delete p_q;
+
+    ASSERT_EQ(GM.setMaxCatchUpSteps(0), -1, "Catch-up limit must be at least 1");
+    ASSERT_EQ(GM.getMaxCatchUpSteps(), MAX_CATCH_UP_STEPS_DEFAULT, "Catch-up limit unchanged");
+
     LM.writeLog("Game loop test complete.");
 }
 
+// -----------------------------------------------------------------------
+// JOB SYSTEM / PARALLEL STEP TESTS
+// -----------------------------------------------------------------------
+// Thread-safe stepper: touches only its own members
+class ParallelStepper : public df::Object {
+public:
+    int steps = 0;
+    bool moves = false;
+    int draws = 0;
+    ParallelStepper() {
+        setSolidness(df::SPECTRAL);
+        registerInterest(STEP_EVENT_ID);
+        setStepThreadSafe();
+    }
+    int eventHandler(const df::Event *p_e) override {
+        if (p_e->getTypeId() != STEP_EVENT_ID) return 0;
+        steps++;
+        if (moves) setPosition(getPosition() + df::Vector(1, 0));
+        return 1;
+    }
+    int draw() override {
+        draws++;
+        return 0;
+    }
+};
+
+static std::string step_order;
+
+// Ordinary stepper: records its turn and checks every parallel stepper
+// already ran this step
+class OrderedStepper : public df::Object {
+public:
+    char tag;
+    int steps = 0;
+    bool saw_lagging = false;
+    const std::vector<ParallelStepper *> *p_parallel;
+    OrderedStepper(char t, const std::vector<ParallelStepper *> *p_watch)
+        : tag(t), p_parallel(p_watch) {
+        registerInterest(STEP_EVENT_ID);
+    }
+    int eventHandler(const df::Event *p_e) override {
+        if (p_e->getTypeId() != STEP_EVENT_ID) return 0;
+        step_order += tag;
+        steps++;
+        for (ParallelStepper *p_s : *p_parallel) {
+            if (p_s->steps != steps) saw_lagging = true;
+        }
+        return 1;
+    }
+};
+
+void testJobSystem() {
+    std::cout << "\n--- Job System Tests ---\n";
+
+    int old_workers = GM.getWorkerCount();
+    ASSERT_EQ(GM.setWorkerCount(-1), -1, "Negative worker count rejected");
+    ASSERT_EQ(GM.getJobs().getWorkerCount(), old_workers, "Job threads started with GM");
+
+    // Every index visited exactly once, with and without workers
+    for (int workers : {3, 0}) {
+        GM.setWorkerCount(workers);
+        const int n = 1000;
+        std::vector<std::atomic<int>> hits(n);
+        for (int round = 0; round < 20; round++) {
+            GM.getJobs().parallelFor(n, 7, [&](int begin, int end) {
+                for (int i = begin; i < end; i++) hits[i]++;
+            });
+        }
+        bool exact = true;
+        for (int i = 0; i < n; i++) exact = exact && hits[i] == 20;
+        ASSERT_TRUE(exact, (workers ? "parallelFor covers range once (3 workers)"
+                                    : "parallelFor covers range once (no workers)"));
+    }
+    std::thread::id caller;
+    GM.setWorkerCount(3);
+    GM.getJobs().parallelFor(10, 64, [&](int, int) { caller = std::this_thread::get_id(); });
+    ASSERT_TRUE(caller == std::this_thread::get_id(), "Single chunk runs on caller");
+
+    // Thread-safe steppers run in parallel before the others, which keep
+    // their order
+    std::vector<ParallelStepper *> parallel;
+    for (int i = 0; i < 500; i++) parallel.push_back(new ParallelStepper());
+    OrderedStepper *p_a = new OrderedStepper('a', &parallel);
+    OrderedStepper *p_b = new OrderedStepper('b', &parallel);
+    OrderedStepper *p_c = new OrderedStepper('c', &parallel);
+    QuitAfterN *p_q = new QuitAfterN(4);
+    step_order.clear();
+    GM.setGameOver(false);
+    GM.run();
+    bool all_stepped = true;
+    for (ParallelStepper *p_s : parallel) all_stepped = all_stepped && p_s->steps == 4;
+    ASSERT_TRUE(all_stepped, "Thread-safe objects stepped once per step");
+    ASSERT_EQ(step_order, std::string("abcabcabcabc"), "Other objects stepped in order");
+    ASSERT_TRUE(!p_a->saw_lagging && !p_c->saw_lagging,
+                "Parallel steps finish before ordered steps");
+
+    for (ParallelStepper *p_s : parallel) delete p_s;
+
+    // Visible thread-safe steppers move themselves in parallel; their
+    // visible boxes are brought up to date when drawn
+    GM.setWorkerCount(4);
+    parallel.clear();
+    for (int i = 0; i < 2000; i++) {
+        ParallelStepper *p_s = new ParallelStepper();
+        p_s->moves = true;
+        p_s->setPosition(df::Vector(0, (float)(i % 20)));
+        parallel.push_back(p_s);
+    }
+    p_q->count = 0;
+    GM.setGameOver(false);
+    GM.run();
+    bool all_moved = true;
+    for (ParallelStepper *p_s : parallel) {
+        all_moved = all_moved && p_s->getPosition().getX() == 4.0f;
+    }
+    ASSERT_TRUE(all_moved, "Thread-safe objects move themselves in parallel");
+    df::Box old_view = WM.getView();
+    WM.setView(df::Box(df::Vector(3, 0), 2, 20)); // (drawn between steps)
+    for (ParallelStepper *p_s : parallel) p_s->draws = 0;
+    WM.draw();
+    bool all_drawn = true;
+    for (ParallelStepper *p_s : parallel) all_drawn = all_drawn && p_s->draws == 1;
+    ASSERT_TRUE(all_drawn, "Objects moved in parallel drawn where they moved to");
+    WM.setView(old_view);
+    for (ParallelStepper *p_s : parallel) delete p_s;
+    delete p_a;
+    delete p_b;
+    delete p_c;
+    delete p_q;
+    GM.setWorkerCount(old_workers);
+    LM.writeLog("Job system tests complete.");
+}
+
 // -----------------------------------------------------------------------
 // MAIN
 // -----------------------------------------------------------------------
-int main() {
+int main(int argc, char *argv[]) {
     std::cout << "======================================\n";
     std::cout << " Dragonfly Engine - Test Suite\n";
     std::cout << "======================================\n";
 
+    // Headless unless asked for a window, so tests run in CI without a display
+    bool use_window = (argc > 1 && std::string(argv[1]) == "--window");
+    DM.setHeadless(!use_window);
+
     // Start engine
     if (GM.startUp() != 0) {
         std::cerr << "ERROR: GameManager failed to start. Is df-font.ttf present?\n";
         return 1;
     }
 
-    std::cout << "All managers started OK.\n";
+    std::cout << "All managers started OK"
+              << (DM.isHeadless() ? " (headless).\n" : ".\n");
 
     // Run tests
     testVector();
@@ -475,11 +1937,26 @@ int main() {
     testObjectList();
     testEvents();
     testLogManager();
+    testLogRecord();
     testObject();
     testWorldManager();
     testStepEvent();
     testEventDispatch();
+    testCollision();
+    testSleep();
+    testDraw();
+    testView();
+    testDisplay();
+    testInput();
     testGameLoop();
+    testJobSystem();
+    testPoolAllocator();
+    testProfiler();
+
+    GM.shutDown();
+
+    // Restarts LogManager on its own, so runs with the engine shut down
+    testLogBinary();
 
     // Summary
     std::cout << "\n======================================\n";
@@ -488,6 +1965,5 @@ int main() {
     std::cout << "======================================\n";
     std::cout << "(See dragonfly.log for detailed engine log)\n";
 
-    GM.shutDown();
     return (tests_failed == 0) ? 0 : 1;
 }